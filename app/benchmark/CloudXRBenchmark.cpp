@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Host and device microbenchmarks for the platform-independent hot paths:
+// pose math, controller profile binding and event remapping, option parsing
+// and log throughput.  Results are written as one json document with a fixed
+// layout, so runs can be diffed or tracked for regressions.
+//
+// Accuracy checks run first and fail the run (exit code 2) when an optimized
+// path drifts from its reference; --check runs only those.
+//
+//   CloudXRBenchmark [--check] [--filter substr] [--repetitions N] [--out file.json]
+
+#define LOG_TAG "CXRBench"
+#include "CloudXRLog.h"
+#include "CloudXRFileLogger.h"
+#include "CloudXRMatrixHelpers.h"
+#include "CloudXRController.h"
+#include "CloudXRClientOptions.h"
+#include "CloudXRInputFilter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// logging hooks the cxrUtils code expects the including binary to provide.
+//-----------------------------------------------------------------------------
+cxrLogFilter g_logFilter;
+
+extern "C" void dispatchLogMsg(cxrLogLevel level, cxrMessageCategory category, void *extra, const char *tag, const char *fmt, ...)
+{
+    va_list aptr;
+    va_start(aptr, fmt);
+    g_logFile.logva(level, tag, fmt, aptr);
+    va_end(aptr);
+}
+
+extern "C" void dispatchLogRecord(cxrLogLevel level, const void* record, uint32_t size)
+{
+    g_logFile.logRecord(level, record, size);
+}
+
+//-----------------------------------------------------------------------------
+// harness
+//-----------------------------------------------------------------------------
+static uint64_t NowNS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+// keeps the compiler from discarding work whose result we never read.
+template <typename T>
+static inline void KeepAlive(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult
+{
+    std::string name;
+    uint64_t opsPerRun;
+    std::vector<double> nsPerOp; // one per repetition
+};
+
+struct Bench
+{
+    const char* name;
+    uint64_t opsPerRun;
+    std::function<void(uint64_t ops)> run;
+};
+
+//-----------------------------------------------------------------------------
+// accuracy checks
+//-----------------------------------------------------------------------------
+// everything is compared per component.  on a unit quaternion 1e-4 is about
+// 2e-4 rad, a wrong lane or sign is off by tenths, float rounding stays under 4e-5.
+static const float PoseMathTolerance = 1e-4f;
+
+static bool RunChecks()
+{
+    bool passed = true;
+
+    const float poseMathError = cxrPoseMathValidate(4096);
+    const bool poseMathOk = poseMathError <= PoseMathTolerance;
+    fprintf(stderr, "check pose_math_batch (%s): max error %g, tolerance %g: %s\n",
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        "neon",
+#else
+        "scalar",
+#endif
+        poseMathError, PoseMathTolerance, poseMathOk ? "ok" : "FAILED");
+    passed &= poseMathOk;
+
+    return passed;
+}
+
+static BenchResult RunBench(const Bench& bench, uint32_t repetitions)
+{
+    BenchResult result;
+    result.name = bench.name;
+    result.opsPerRun = bench.opsPerRun;
+
+    bench.run(bench.opsPerRun / 10 + 1); // warm caches and branch predictors.
+    for (uint32_t r = 0; r < repetitions; ++r)
+    {
+        const uint64_t start = NowNS();
+        bench.run(bench.opsPerRun);
+        const uint64_t elapsed = NowNS() - start;
+        result.nsPerOp.push_back((double)elapsed / (double)bench.opsPerRun);
+    }
+    return result;
+}
+
+static void WriteJson(FILE* out, const std::vector<BenchResult>& results, uint32_t repetitions)
+{
+    fprintf(out, "{\n  \"schema\": 1,\n  \"version\": \"%s\",\n  \"repetitions\": %u,\n  \"benchmarks\": [\n",
+            CLOUDXR_VERSION, repetitions);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        std::vector<double> sorted = results[i].nsPerOp;
+        std::sort(sorted.begin(), sorted.end());
+        const double median = sorted[sorted.size() / 2];
+        fprintf(out, "    { \"name\": \"%s\", \"ops\": %llu, \"ns_per_op_median\": %.3f, \"ns_per_op_min\": %.3f, \"ns_per_op_max\": %.3f }%s\n",
+                results[i].name.c_str(), (unsigned long long)results[i].opsPerRun,
+                median, sorted.front(), sorted.back(), (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+//-----------------------------------------------------------------------------
+// fixtures
+//-----------------------------------------------------------------------------
+static const char* s_questInputs[] =
+{
+    "/input/system/click", "/input/application_menu/click",
+    "/input/trigger/click", "/input/trigger/touch", "/input/trigger/value",
+    "/input/grip/click", "/input/grip/touch", "/input/grip/value",
+    "/input/joystick/click", "/input/joystick/touch", "/input/joystick/x", "/input/joystick/y",
+    "/input/a/click", "/input/b/click", "/input/x/click", "/input/y/click",
+    "/input/a/touch", "/input/b/touch", "/input/x/touch", "/input/y/touch",
+    "/input/thumb_rest/touch",
+};
+static const uint32_t s_questInputCount = sizeof(s_questInputs) / sizeof(s_questInputs[0]);
+
+static cxrInputValueType QuestInputType(uint32_t i)
+{
+    return (i == 4 || i == 7 || i == 10 || i == 11) ? cxrInputValueType_float32 : cxrInputValueType_boolean;
+}
+
+struct ControllerFixture
+{
+    std::vector<cxrInputValueType> types;
+    std::vector<std::string> actionNames;
+    std::vector<const char*> actions;
+    std::map<std::string, std::string> profile;
+
+    ControllerFixture()
+    {
+        for (uint32_t i = 0; i < s_questInputCount; ++i)
+            types.push_back(QuestInputType(i));
+        // action 0 is reserved for 'unbound'.
+        actionNames.push_back("/actions/none");
+        for (uint32_t i = 0; i < s_questInputCount; ++i)
+            actionNames.push_back(std::string("/actions/main/in") + s_questInputs[i]);
+        for (const auto& a : actionNames)
+            actions.push_back(a.c_str());
+        for (uint32_t i = 0; i < s_questInputCount; ++i)
+            profile[s_questInputs[i]] = actionNames[i + 1];
+    }
+
+    void Setup(CloudXRController& controller)
+    {
+        cxrControllerDesc desc = {};
+        desc.id = 0;
+        desc.role = "cxr://input/hand/left";
+        desc.controllerName = "Oculus Touch";
+        desc.inputCount = s_questInputCount;
+        desc.inputPaths = s_questInputs;
+        desc.inputValueTypes = types.data();
+        controller.RegisterController(desc);
+        controller.SetServerInputs(s_questInputCount, s_questInputs, types.data());
+        controller.SetServerActions((uint32_t)actions.size(), actions.data());
+    }
+};
+
+// deterministic unit quaternions and vectors, so every run does the same work.
+static void FillPoses(cxrQuaternion* quats, cxrVector3* vecs, uint32_t count)
+{
+    uint32_t seed = 777;
+    auto rnd = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) * (2.0f / 16777216.0f) - 1.0f; };
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        cxrQuaternion q = { rnd(), rnd(), rnd(), rnd() };
+        const float len = sqrtf(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z) + 1e-6f;
+        quats[i] = { q.w / len, q.x / len, q.y / len, q.z / len };
+        vecs[i] = {{ rnd(), rnd(), rnd() }};
+    }
+}
+
+// mutes the stdout echo FileLogger does on desktop, so we time the file path.
+class ScopedMuteStdout
+{
+public:
+    ScopedMuteStdout()
+    {
+        fflush(stdout);
+        m_saved = dup(STDOUT_FILENO);
+        const int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0)
+        {
+            dup2(devNull, STDOUT_FILENO);
+            close(devNull);
+        }
+    }
+    ~ScopedMuteStdout()
+    {
+        fflush(stdout);
+        if (m_saved >= 0)
+        {
+            dup2(m_saved, STDOUT_FILENO);
+            close(m_saved);
+        }
+    }
+private:
+    int m_saved = -1;
+};
+
+// one logger session per mode, producer side cost per line.  async includes
+// the final drain in the measurement, spread over the lines.
+static void RunLogBench(bool async, bool deferred, uint64_t lines)
+{
+    // log names only resolve to the second, so count runs to keep them apart.
+    static uint32_t s_run = 0;
+    ScopedMuteStdout mute;
+    std::string prefix = async ? (deferred ? "Bench Deferred" : "Bench Async") : "Bench Sync";
+    prefix += " " + std::to_string(++s_run);
+    g_logFile.setLogLevel(cxrLL_Info);
+    g_logFile.setMaxSizeKB(16 * 1024);
+    g_logFile.setAsync(async);
+    // the logger wants an absolute path, keep the files beside wherever we run.
+    char cwd[1024] = "";
+    if (!getcwd(cwd, sizeof(cwd)))
+        strcpy(cwd, "/tmp");
+    g_logFile.init(std::string(cwd) + "/cxrbench_logs", prefix);
+    g_logFilter.minLevel = cxrLL_Info;
+    g_logFilter.deferred = deferred && g_logFile.isAsyncRunning();
+
+    for (uint64_t i = 0; i < lines; ++i)
+        CXR_LOGI("frame %llu latched in %.3f ms, pose age %.3f ms, queue %d",
+                 (unsigned long long)i, 1.25f + (i & 7), 3.5f, (int)(i & 3));
+
+    // destroy drains the writer, so async numbers include getting it all on disk.
+    g_logFilter.deferred = false;
+    g_logFile.destroy();
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string outPath;
+    uint32_t repetitions = 5;
+    bool checkOnly = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--check"))
+            checkOnly = true;
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            outPath = argv[++i];
+        else if (!strcmp(argv[i], "--repetitions") && i + 1 < argc)
+            repetitions = std::max(1, atoi(argv[++i]));
+        else
+        {
+            fprintf(stderr, "usage: %s [--check] [--filter substr] [--repetitions N] [--out file.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // nothing but the benchmarks themselves should log.
+    g_logFile.setLogLevel(cxrLL_Warning);
+    g_logFilter.minLevel = cxrLL_Warning;
+
+    // numbers from a path that gives wrong answers aren't worth writing out.
+    if (!RunChecks())
+        return 2;
+    if (checkOnly)
+        return 0;
+
+    static const uint32_t PoseCount = 1024;
+    static cxrQuaternion s_quats[PoseCount];
+    static cxrVector3 s_vecs[PoseCount];
+    FillPoses(s_quats, s_vecs, PoseCount);
+    const cxrQuaternion touchRotation = { cosf(0.225f), sinf(0.225f), 0.0f, 0.0f };
+
+    ControllerFixture fixture;
+
+    std::vector<Bench> benches;
+
+    // HMD + 2 controllers per op, the old path: quat -> matrix, multiply, matrix -> quat.
+    benches.push_back({ "pose_convert_matrix_x3", 200000, [&](uint64_t ops) {
+        cxrMatrix34 fix;
+        cxrVecQuatToMatrix(NULL, &touchRotation, &fix);
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            for (uint32_t p = 0; p < 3; ++p)
+            {
+                const uint32_t i = (uint32_t)((op * 3 + p) & (PoseCount - 1));
+                cxrMatrix34 m, mr;
+                cxrVecQuatToMatrix(&s_vecs[i], &s_quats[i], &m);
+                for (int r = 0; r < 3; ++r)
+                    for (int c = 0; c < 4; ++c)
+                        mr.m[r][c] = m.m[r][0] * fix.m[0][c] + m.m[r][1] * fix.m[1][c] + m.m[r][2] * fix.m[2][c] + (c == 3 ? m.m[r][3] : 0.0f);
+                cxrVector3 pos;
+                cxrQuaternion rot;
+                cxrMatrixToVecQuat(&mr, &pos, &rot);
+                KeepAlive(rot);
+                KeepAlive(pos);
+            }
+        }
+    }});
+
+    // the same work as one quaternion batch.
+    benches.push_back({ "pose_convert_quat_batch_x3", 200000, [&](uint64_t ops) {
+        cxrQuaternion4 rotation;
+        cxrQuat4SetIdentity(&rotation);
+        for (int lane = 0; lane < 3; ++lane)
+            cxrQuat4Set(&rotation, lane, &touchRotation);
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            cxrQuaternion4 orientation, result;
+            cxrQuat4SetIdentity(&orientation);
+            for (uint32_t p = 0; p < 3; ++p)
+                cxrQuat4Set(&orientation, p, &s_quats[(op * 3 + p) & (PoseCount - 1)]);
+            cxrQuatMultiply4(&orientation, &rotation, &result);
+            cxrQuatCanonicalize4(&result);
+            KeepAlive(result);
+        }
+    }});
+
+    benches.push_back({ "angular_velocity_matrix_inverse", 500000, [&](uint64_t ops) {
+        const cxrVector3 zero = {{ 0, 0, 0 }};
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            const uint32_t i = (uint32_t)(op & (PoseCount - 1));
+            cxrMatrix34 m, inv;
+            cxrVecQuatToMatrix(&zero, &s_quats[i], &m);
+            cxrInverseMatrix(&m, &inv);
+            cxrVector3 out;
+            cxrTransformVector(&inv, &s_vecs[i], &out);
+            KeepAlive(out);
+        }
+    }});
+
+    benches.push_back({ "angular_velocity_quat_conjugate", 500000, [&](uint64_t ops) {
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            const uint32_t i = (uint32_t)(op & (PoseCount - 1));
+            const cxrQuaternion inverse = cxrQuatConjugate(&s_quats[i]);
+            cxrVector3 out;
+            cxrQuatRotateVector(&inverse, &s_vecs[i], &out);
+            KeepAlive(out);
+        }
+    }});
+
+    benches.push_back({ "profile_bind_quest", 2000, [&](uint64_t ops) {
+        CloudXRController controller(0, true);
+        fixture.Setup(controller);
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            controller.SetProfile(fixture.profile);
+            KeepAlive(controller);
+        }
+    }});
+
+    // one poll's worth of events per op: both analog triggers, sticks and a few buttons.
+    benches.push_back({ "event_remap_16", 200000, [&](uint64_t ops) {
+        CloudXRController controller(0, true);
+        fixture.Setup(controller);
+        controller.SetProfile(fixture.profile);
+        static const uint32_t indices[16] = { 4, 7, 10, 11, 2, 3, 5, 6, 8, 9, 12, 13, 16, 17, 20, 0 };
+        cxrControllerEvent events[16] = {};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            events[i].clientInputIndex = indices[i];
+            events[i].inputValue.valueType = QuestInputType(indices[i]);
+        }
+        std::vector<cxrActionEvent> queue;
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            queue.clear();
+            controller.HandleModernEvents(queue, events, 16);
+            KeepAlive(queue.size());
+        }
+    }});
+
+    benches.push_back({ "analog_filter", 1000000, [&](uint64_t ops) {
+        cxrAnalogInputFilter f;
+        f.Configure(-1.0f, 1.0f, true, 0.01f, 0, 0);
+        f.Reset();
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            float out;
+            KeepAlive(f.Filter(s_vecs[op & (PoseCount - 1)].v[0], op * 2000000, out));
+        }
+    }});
+
+    benches.push_back({ "options_construct", 2000, [&](uint64_t ops) {
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            CloudXR::ClientOptions options;
+            KeepAlive(options.mMaxResFactor);
+        }
+    }});
+
+    benches.push_back({ "options_parse_string", 20000, [&](uint64_t ops) {
+        CloudXR::ClientOptions options;
+        for (uint64_t op = 0; op < ops; ++op)
+        {
+            options.ParseString("-s 10.0.0.2 -m 1.5 -f 50 -mb 60 -tr 500 -pm adaptive -lm reproject -asc -idb 0.02 -lc performance");
+            KeepAlive(options.mMaxResFactor);
+        }
+    }});
+
+    benches.push_back({ "log_sync_line", 20000, [&](uint64_t ops) { RunLogBench(false, false, ops); } });
+    // async runs stay under the ring size (2048 lines), past that a tight loop
+    // outruns the writer and we'd be timing dropped lines.
+    benches.push_back({ "log_async_line", 2000, [&](uint64_t ops) { RunLogBench(true, false, ops); } });
+#if CXR_LOG_DEFERRED_SUPPORTED
+    benches.push_back({ "log_deferred_line", 2000, [&](uint64_t ops) { RunLogBench(true, true, ops); } });
+#endif
+
+    std::vector<BenchResult> results;
+    for (const Bench& bench : benches)
+    {
+        if (!filter.empty() && std::string(bench.name).find(filter) == std::string::npos)
+            continue;
+        fprintf(stderr, "running %s\n", bench.name);
+        results.push_back(RunBench(bench, repetitions));
+    }
+
+    FILE* out = stdout;
+    if (!outPath.empty())
+    {
+        out = fopen(outPath.c_str(), "w");
+        if (!out)
+        {
+            fprintf(stderr, "could not open %s\n", outPath.c_str());
+            return 1;
+        }
+    }
+    WriteJson(out, results, repetitions);
+    if (out != stdout)
+        fclose(out);
+
+    return 0;
+}
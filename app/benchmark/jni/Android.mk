@@ -0,0 +1,27 @@
+# Device build of the cxrUtils microbenchmarks, as a standalone executable:
+#
+#   ndk-build -C app/benchmark C_SHARED_INCLUDE=$PWD/app/cxrUtils CLOUDXR_SDK_ROOT=$PWD/app/build/CloudXR
+#   adb push app/benchmark/libs/arm64-v8a/CloudXRBenchmark /data/local/tmp/
+#   adb shell "cd /data/local/tmp && ./CloudXRBenchmark --out bench.json"
+#   adb shell /data/local/tmp/CloudXRBenchmark --check    # NEON accuracy checks only
+
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := CloudXRBenchmark
+
+LOCAL_CPP_FEATURES := exceptions
+
+LOCAL_C_INCLUDES := $(C_SHARED_INCLUDE) \
+                    $(CLOUDXR_SDK_ROOT)/include
+
+LOCAL_SRC_FILES := ../CloudXRBenchmark.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRController.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRFileLogger.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRLogDeferred.cpp
+
+LOCAL_CFLAGS += -O2
+LOCAL_LDLIBS := -llog
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,3 @@
+APP_ABI := arm64-v8a
+APP_PLATFORM := android-25
+APP_STL := c++_static
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_AUDIO_JITTER_BUFFER_H
+#define CLOUDXR_AUDIO_JITTER_BUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+// Single-producer, single-consumer jitter buffer for interleaved 16-bit PCM.
+// The producer is whatever thread hands us decoded audio, and it never blocks:
+// if there's no room the packet is dropped and counted as an overrun.  The
+// consumer is the device callback, which always gets a full buffer back, padded
+// with silence when starved.
+//
+// The producer tracks arrival jitter and publishes a target depth from it.  The
+// consumer re-primes to that target after an underrun, and keeps the average
+// depth near it by dropping or repeating one frame per callback, which absorbs
+// clock drift between the sender and the local device without a resampler.
+class cxrAudioJitterBuffer
+{
+public:
+    struct Stats
+    {
+        uint32_t underruns;         // callbacks that ran dry, each one re-primes.
+        uint32_t overruns;          // packets dropped because the ring was full.
+        uint32_t droppedFrames;     // removed by drift compensation.
+        uint32_t insertedFrames;    // repeated by drift compensation.
+        uint32_t targetFrames;
+        uint32_t queuedFrames;
+        float jitterMs;
+    };
+
+    // not real-time safe, call before the device stream starts.
+    void Init(uint32_t channels, uint32_t sampleRate, uint32_t minLatencyMs, uint32_t maxLatencyMs)
+    {
+        m_channels = channels;
+        m_sampleRate = sampleRate;
+        m_minFrames = minLatencyMs * sampleRate / 1000;
+        m_maxFrames = maxLatencyMs * sampleRate / 1000;
+        if (m_maxFrames < m_minFrames)
+            m_maxFrames = m_minFrames;
+
+        // twice the deepest target, so a burst on top of it still fits.
+        uint32_t capacity = 1;
+        while (capacity < m_maxFrames * 2)
+            capacity <<= 1;
+        m_mask = capacity - 1;
+        m_samples.assign((size_t)capacity * channels, 0);
+        Reset();
+    }
+
+    // only while neither side is running.
+    void Reset()
+    {
+        m_writePos.store(0, std::memory_order_relaxed);
+        m_readPos.store(0, std::memory_order_relaxed);
+        m_targetFrames.store(m_minFrames, std::memory_order_relaxed);
+        m_jitterUs.store(0, std::memory_order_relaxed);
+        m_underruns.store(0, std::memory_order_relaxed);
+        m_overruns.store(0, std::memory_order_relaxed);
+        m_droppedFrames.store(0, std::memory_order_relaxed);
+        m_insertedFrames.store(0, std::memory_order_relaxed);
+
+        m_lastArrivalNs = 0;
+        m_jitterFrames = 0;
+        m_packetFrames = 0;
+        m_boostFrames = 0;
+        m_seenUnderruns = 0;
+
+        m_priming = true;
+        m_avgQueued = 0;
+    }
+
+    // consumer side, with the device stream stopped.  drops whatever is queued
+    // and primes again, so a restarted stream doesn't begin on old audio.
+    void Flush()
+    {
+        m_readPos.store(m_writePos.load(std::memory_order_acquire), std::memory_order_release);
+        m_priming = true;
+        m_avgQueued = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // producer
+    //-------------------------------------------------------------------------
+    // returns false if the packet was dropped.
+    bool Write(const int16_t* samples, uint32_t frames, int64_t nowNs)
+    {
+        if (frames == 0 || m_samples.empty())
+            return true;
+
+        UpdateTarget(frames, nowNs);
+
+        const uint64_t w = m_writePos.load(std::memory_order_relaxed);
+        const uint64_t r = m_readPos.load(std::memory_order_acquire);
+        if (w - r + frames > m_mask + 1)
+        {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        CopyIn(w, samples, frames);
+        m_writePos.store(w + frames, std::memory_order_release);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // consumer, real-time safe.  out always gets frames worth of samples.
+    //-------------------------------------------------------------------------
+    void Read(int16_t* out, uint32_t frames)
+    {
+        const uint64_t r = m_readPos.load(std::memory_order_relaxed);
+        const uint64_t w = m_writePos.load(std::memory_order_acquire);
+        const uint32_t queued = (uint32_t)(w - r);
+        const uint32_t target = m_targetFrames.load(std::memory_order_relaxed);
+
+        if (m_priming)
+        {
+            if (queued < target || queued < frames)
+            {
+                memset(out, 0, (size_t)frames * m_channels * sizeof(int16_t));
+                return;
+            }
+            m_priming = false;
+            m_avgQueued = (float)queued;
+        }
+
+        if (queued < frames)
+        {
+            // play what's left, then wait for the target again rather than
+            // stuttering on every packet that arrives.
+            CopyOut(r, out, queued);
+            memset(out + (size_t)queued * m_channels, 0, (size_t)(frames - queued) * m_channels * sizeof(int16_t));
+            m_readPos.store(r + queued, std::memory_order_release);
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+            m_priming = true;
+            return;
+        }
+
+        // slow average, so packet-sized swings in depth don't count as drift.
+        m_avgQueued += ((float)queued - m_avgQueued) * (1.0f / 64.0f);
+        const float band = (float)target * 0.25f + (float)frames;
+
+        uint32_t consumed = frames;
+        if (m_avgQueued > (float)target + band && queued > frames && m_channels <= MaxChannels)
+        {
+            // one frame too many: fold it into the last one we play.
+            CopyOut(r, out, frames);
+            int16_t extra[MaxChannels];
+            CopyOut(r + frames, extra, 1);
+            int16_t* last = out + (size_t)(frames - 1) * m_channels;
+            for (uint32_t c = 0; c < m_channels; ++c)
+                last[c] = (int16_t)(((int32_t)last[c] + extra[c]) / 2);
+            consumed = frames + 1;
+            m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (m_avgQueued < (float)target - band && frames > 1)
+        {
+            // one short: repeat the last frame we have.
+            CopyOut(r, out, frames - 1);
+            memcpy(out + (size_t)(frames - 1) * m_channels, out + (size_t)(frames - 2) * m_channels,
+                   m_channels * sizeof(int16_t));
+            consumed = frames - 1;
+            m_insertedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            CopyOut(r, out, frames);
+        }
+
+        m_readPos.store(r + consumed, std::memory_order_release);
+    }
+
+    // any thread, values are individually consistent only.
+    void GetStats(Stats& stats) const
+    {
+        const uint64_t w = m_writePos.load(std::memory_order_acquire);
+        const uint64_t r = m_readPos.load(std::memory_order_acquire);
+        stats.underruns = m_underruns.load(std::memory_order_relaxed);
+        stats.overruns = m_overruns.load(std::memory_order_relaxed);
+        stats.droppedFrames = m_droppedFrames.load(std::memory_order_relaxed);
+        stats.insertedFrames = m_insertedFrames.load(std::memory_order_relaxed);
+        stats.targetFrames = m_targetFrames.load(std::memory_order_relaxed);
+        stats.queuedFrames = (w > r) ? (uint32_t)(w - r) : 0;
+        stats.jitterMs = m_jitterUs.load(std::memory_order_relaxed) / 1000.0f;
+    }
+
+    uint32_t SampleRate() const { return m_sampleRate; }
+
+private:
+    static const uint32_t MaxChannels = 8;
+    static constexpr int64_t MaxArrivalGapNs = 1000000000;
+
+    // producer only.  RFC 3550 style smoothed jitter of packet arrival against
+    // the audio time the previous packet carried.  the target covers one packet
+    // plus a few deviations, and gets pushed up for a while after each underrun.
+    void UpdateTarget(uint32_t frames, int64_t nowNs)
+    {
+        // a gap this long is the stream pausing, not network jitter.
+        if (m_lastArrivalNs != 0 && nowNs - m_lastArrivalNs > MaxArrivalGapNs)
+            m_lastArrivalNs = 0;
+        if (m_lastArrivalNs != 0 && m_packetFrames != 0)
+        {
+            const double expectedNs = (double)m_packetFrames * 1e9 / m_sampleRate;
+            const double deviationFrames = fabs((double)(nowNs - m_lastArrivalNs) - expectedNs) * m_sampleRate / 1e9;
+            m_jitterFrames += (deviationFrames - m_jitterFrames) / 16.0;
+        }
+        m_lastArrivalNs = nowNs;
+        m_packetFrames = frames;
+
+        const uint32_t underruns = m_underruns.load(std::memory_order_relaxed);
+        if (underruns != m_seenUnderruns)
+        {
+            m_seenUnderruns = underruns;
+            m_boostFrames += frames;
+        }
+        else
+        {
+            m_boostFrames *= (1.0 - 1.0 / 512.0); // many seconds to decay.
+        }
+
+        double target = (double)frames + 4.0 * m_jitterFrames + m_boostFrames;
+        if (target < m_minFrames) target = m_minFrames;
+        if (target > m_maxFrames) target = m_maxFrames;
+        if (m_boostFrames > m_maxFrames) m_boostFrames = m_maxFrames;
+
+        m_targetFrames.store((uint32_t)target, std::memory_order_relaxed);
+        m_jitterUs.store((uint32_t)(m_jitterFrames * 1e6 / m_sampleRate), std::memory_order_relaxed);
+    }
+
+    void CopyIn(uint64_t pos, const int16_t* src, uint32_t frames)
+    {
+        const uint32_t start = (uint32_t)(pos & m_mask);
+        const uint32_t first = (frames < m_mask + 1 - start) ? frames : (m_mask + 1 - start);
+        memcpy(&m_samples[(size_t)start * m_channels], src, (size_t)first * m_channels * sizeof(int16_t));
+        if (first < frames)
+            memcpy(&m_samples[0], src + (size_t)first * m_channels, (size_t)(frames - first) * m_channels * sizeof(int16_t));
+    }
+
+    void CopyOut(uint64_t pos, int16_t* dst, uint32_t frames) const
+    {
+        const uint32_t start = (uint32_t)(pos & m_mask);
+        const uint32_t first = (frames < m_mask + 1 - start) ? frames : (m_mask + 1 - start);
+        memcpy(dst, &m_samples[(size_t)start * m_channels], (size_t)first * m_channels * sizeof(int16_t));
+        if (first < frames)
+            memcpy(dst + (size_t)first * m_channels, &m_samples[0], (size_t)(frames - first) * m_channels * sizeof(int16_t));
+    }
+
+    uint32_t m_channels = 0;
+    uint32_t m_sampleRate = 0;
+    uint32_t m_minFrames = 0;
+    uint32_t m_maxFrames = 0;
+    uint32_t m_mask = 0;
+    std::vector<int16_t> m_samples;
+
+    std::atomic<uint64_t> m_writePos{0};
+    std::atomic<uint64_t> m_readPos{0};
+    std::atomic<uint32_t> m_targetFrames{0};
+    std::atomic<uint32_t> m_jitterUs{0};
+    std::atomic<uint32_t> m_underruns{0};
+    std::atomic<uint32_t> m_overruns{0};
+    std::atomic<uint32_t> m_droppedFrames{0};
+    std::atomic<uint32_t> m_insertedFrames{0};
+
+    // producer only
+    int64_t m_lastArrivalNs = 0;
+    double m_jitterFrames = 0;
+    uint32_t m_packetFrames = 0;
+    double m_boostFrames = 0;
+    uint32_t m_seenUnderruns = 0;
+
+    // consumer only
+    bool m_priming = true;
+    float m_avgQueued = 0;
+};
+
+#endif // CLOUDXR_AUDIO_JITTER_BUFFER_H
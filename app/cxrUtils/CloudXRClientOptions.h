@@ -24,21 +24,39 @@
 #define CLOUDXR_CLIENT_OPTIONS_H
 
 #include <string>
+#include <vector>
 #include <sstream>
 #include <fstream>
 #include <stdint.h>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 
 #include "CloudXROptionsParser.h"
 #include "CloudXRClient.h"
 
 namespace CloudXR {
 
+typedef enum
+{
+    PredictionMode_Fixed = 0,       // predict by constant client offset (0 == let vrapi filter at 'now')
+    PredictionMode_Adaptive = 1,    // predict to the display time the streamed frame will land on
+} PredictionMode;
+
+typedef enum
+{
+    LatchMode_Blocking = 0,     // wait up to 500ms for a new frame, draw background on timeout
+    LatchMode_Reproject = 1,    // wait only until the display deadline, resubmit the last frame on timeout
+} LatchMode;
+
 class ClientOptions : public OptionsParser
 {
 public:
     std::string mServerIP;
+    std::vector<std::string> mServerCandidates; // all given to -server, mServerIP is the one in use.
+    uint32_t mServerProbes;
+    std::string mControlSocket;
+    int32_t mLogLevel; // -1 picks from the debug flags.
     std::string mUserData;
     bool mWindowed;
     bool mBtnRemap;
@@ -55,12 +73,44 @@ public:
     uint32_t mDebugFlags;
     int32_t mLogMaxAgeDays;
     int32_t mLogMaxSizeKB;
+    float mTrackingRate;
+    bool mTrackingDisplayAligned;
+    int32_t mTrackingCpu;
+    // these four can change over the control channel while the render and
+    // tracking threads read them, the rest are only read where they're set.
+    std::atomic<PredictionMode> mPredictionMode;
+    std::atomic<LatchMode> mLatchMode;
+    bool mArraySwapchain;
+    std::atomic<bool> mFrameTimingCsv;
+    std::atomic<bool> mStatsHud;
+    bool mTrackingRecord;
+    std::string mTrackingReplay;
+    uint32_t mStatsSummarySec;
+    bool mLogAsync;
+    bool mLogDeferred;
+    uint32_t mLogCategoryMask;
+    float mInputDeadband;
+    uint32_t mInputQuantize;
+    float mInputAxisRate;
+    uint32_t mAudioLatencyMinMs;
+    uint32_t mAudioLatencyMaxMs;
+    uint32_t mMicFrameMs;
+    bool mQualityGovernor;
+    bool mClockGovernor;
+    int32_t mCpuLevelMin;
+    int32_t mCpuLevelMax;
+    int32_t mGpuLevelMin;
+    int32_t mGpuLevelMax;
+    uint32_t mWarmSuspendS;
     cxrNetworkInterface mClientNetwork;
     cxrNetworkTopology mTopology;
     cxrGraphicsContextType mGfxType;
 
     ClientOptions() :
             mServerIP{""},
+            mServerProbes(5),
+            mControlSocket{""},
+            mLogLevel(-1),
             mUserData{""},
             mWindowed(false),
             mBtnRemap(true),
@@ -77,6 +127,33 @@ public:
             mDebugFlags(0),
             mLogMaxAgeDays(-1),
             mLogMaxSizeKB(-1),
+            mTrackingRate(0),
+            mTrackingDisplayAligned(false),
+            mTrackingCpu(-1),
+            mPredictionMode(PredictionMode_Fixed),
+            mLatchMode(LatchMode_Blocking),
+            mArraySwapchain(false),
+            mFrameTimingCsv(false),
+            mStatsHud(false),
+            mTrackingRecord(false),
+            mTrackingReplay{""},
+            mStatsSummarySec(0),
+            mLogAsync(false),
+            mLogDeferred(false),
+            mLogCategoryMask(0xFFFFFFFF),
+            mInputDeadband(0.01f),
+            mInputQuantize(0),
+            mInputAxisRate(0),
+            mAudioLatencyMinMs(20),
+            mAudioLatencyMaxMs(150),
+            mMicFrameMs(10),
+            mQualityGovernor(false),
+            mClockGovernor(false),
+            mCpuLevelMin(1),
+            mCpuLevelMax(4),
+            mGpuLevelMin(1),
+            mGpuLevelMax(4),
+            mWarmSuspendS(0),
             mClientNetwork(cxrNetworkInterface_Unknown),
             mTopology(cxrNetworkTopology_LAN),
 #ifdef _WIN32
@@ -89,8 +166,25 @@ public:
 #endif
 #endif
     {
-        AddOption("server", "s", true, "IP address of server to connect to",
-                  HANDLER_LAMBDA_FN {mServerIP = tok; return ParseStatus_Success;});
+        AddOption("server", "s", true, "IP address of server to connect to, or a comma-separated list of candidates to probe, connect to the fastest and fail over to the next",
+            HANDLER_LAMBDA_FN
+            {
+                std::vector<std::string> servers;
+                std::stringstream ss(tok);
+                std::string server;
+                while (std::getline(ss, server, ','))
+                {
+                    server.erase(0, server.find_first_not_of(" \t"));
+                    server.erase(server.find_last_not_of(" \t") + 1);
+                    if (!server.empty())
+                        servers.push_back(server);
+                }
+                if (servers.empty())
+                    return ParseStatus_BadVal;
+                mServerCandidates = servers;
+                mServerIP = servers[0];
+                return ParseStatus_Success;
+            });
 
         AddOption("user-data", "u", true, "Send a user string to the server",
             HANDLER_LAMBDA_FN{ mUserData = tok; return ParseStatus_Success; });
@@ -101,7 +195,7 @@ public:
         AddOption("no-button-remap", "b", false, "Do not remap various controller buttons to SteamVR system menu and other functions",
                   HANDLER_LAMBDA_FN { mBtnRemap = false; return ParseStatus_Success;});
 
-        AddOption("latency-test", "l", false, "Runs local latency testing, where screen is black when no input, changes to white with input",
+        AddOption("latency-test", "l", false, "Measures latency and writes distributions to the log folder.  Alone, the screen is black and flips to white while A, X or a trigger is held, timed from input to display.  With -server, times each frame's pose from sampling to display through the stream, and embeds client info in the frames",
             HANDLER_LAMBDA_FN{ mTestLatency = true; return ParseStatus_Success; });
 
         AddOption("enable-alpha", "a", false, "Enable streaming alpha",
@@ -161,9 +255,9 @@ public:
         AddOption("max-video-bitrate", "mb", true, "Maximum bitrate to use for video in mbps",
             HANDLER_LAMBDA_FN{ std::stringstream ss(tok); ss >> mMaxVideoBitrate; mMaxVideoBitrate *= 1000; return ParseStatus_Success; });
 
-        AddOption("log-verbose", "v", false, "Enable more verbose logging",
+        AddOption("log-verbose", "v", false, "Enable more verbose logging, to both the log file and logcat",
             HANDLER_LAMBDA_FN{ mDebugFlags |= cxrDebugFlags_LogVerbose; return ParseStatus_Success; });
-        AddOption("log-quiet", "q", false, "Disable logging to file, use only debug output",
+        AddOption("log-quiet", "q", false, "Disable logging, to both the log file and logcat, once the logger is up",
             HANDLER_LAMBDA_FN{ mDebugFlags |= cxrDebugFlags_LogQuiet; return ParseStatus_Success; });
         AddOption("trace-stream-events", "t", false, "Enable tracing of streaming events",
             HANDLER_LAMBDA_FN{ mDebugFlags |= cxrDebugFlags_TraceStreamEvents; return ParseStatus_Success; });
@@ -192,6 +286,35 @@ public:
         AddOption("disable-mqos", "dmq", false, "Disable Multistream QoS",
             HANDLER_LAMBDA_FN{ mDebugFlags |= cxrDebugFlags_DisableMultistreamQoS; return ParseStatus_Success; });
 
+        AddOption("log-async", "la", false, "Write the log file from a background thread, so logging threads never block on file i/o",
+            HANDLER_LAMBDA_FN{ mLogAsync = true; return ParseStatus_Success; });
+
+        AddOption("log-deferred", "ld", false, "Log from our own code by capturing raw arguments and formatting on the log writer thread.  Implies log-async.",
+            HANDLER_LAMBDA_FN{ mLogDeferred = true; mLogAsync = true; return ParseStatus_Success; });
+
+        AddOption("log-category", "lc", true, "Only log messages of the given category, to both the log file and logcat. [all|correctness|performance]",
+            HANDLER_LAMBDA_FN
+            {
+                if (tok == "all")
+                {
+                    mLogCategoryMask = 0xFFFFFFFF;
+                }
+                else if (tok == "correctness")
+                {
+                    mLogCategoryMask = 1u << cxrMC_Correctness;
+                }
+                else if (tok == "performance")
+                {
+                    mLogCategoryMask = 1u << cxrMC_Performance;
+                }
+                else
+                {
+                    return ParseStatus_BadVal;
+                }
+
+                return ParseStatus_Success;
+            });
+
         AddOption("log-max-days", "lmd", true, "Maximum number of days until which logs persist.  -1 resets to default, 0 to never prune, or [1-365] days.",
             HANDLER_LAMBDA_FN
             {
@@ -208,7 +331,7 @@ public:
                 return ParseStatus_BadVal;
             });
 
-        AddOption("log-max-kb", "lmk", true, "Maximum log size in kilobytes. -1 resets default, 0 for no cap, max 1024*1024K (1GB)",
+        AddOption("log-max-kb", "lmk", true, "Maximum log size in kilobytes, the newest output is kept in rotating segments. -1 resets default, 0 for no cap, max 1024*1024K (1GB)",
             HANDLER_LAMBDA_FN
             {
                 int32_t max;
@@ -224,6 +347,252 @@ public:
                 return ParseStatus_BadVal;
             });
 
+        AddOption("tracking-rate", "tr", true, "Sample tracking+input on a dedicated thread at given rate in hz [30-1000], or 'display' to align to display refresh.  0 samples inline in the server callback.",
+            HANDLER_LAMBDA_FN
+            {
+                if (tok == "display")
+                {
+                    mTrackingDisplayAligned = true;
+                    mTrackingRate = 0;
+                    return ParseStatus_Success;
+                }
+
+                float rate = 0;
+                std::stringstream ss(tok); ss >> rate;
+                if (rate == 0.0f)
+                {
+                    mTrackingDisplayAligned = false;
+                    mTrackingRate = 0;
+                    return ParseStatus_Success;
+                }
+
+                if (rate >= 30.0f && rate <= 1000.0f)
+                {
+                    mTrackingDisplayAligned = false;
+                    mTrackingRate = rate;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("tracking-cpu", "tcpu", true, "Pin the tracking sampler thread to the given cpu core.  -1 leaves scheduling to the OS.",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t cpu;
+                std::stringstream ss(tok); ss >> cpu;
+                if (cpu >= -1 && cpu < 64)
+                {
+                    mTrackingCpu = cpu;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("prediction-mode", "pm", true, "Choose client pose prediction. [fixed|adaptive]  Adaptive predicts to display time from measured round-trip and latch latency.",
+            HANDLER_LAMBDA_FN
+            {
+                if (tok == "fixed")
+                {
+                    mPredictionMode = PredictionMode_Fixed;
+                }
+                else if (tok == "adaptive")
+                {
+                    mPredictionMode = PredictionMode_Adaptive;
+                }
+                else
+                {
+                    return ParseStatus_BadVal;
+                }
+
+                return ParseStatus_Success;
+            });
+
+        AddOption("latch-mode", "lm", true, "Choose frame latch behavior. [blocking|reproject]  Reproject latches within the display deadline and resubmits the last frame when none arrived.",
+            HANDLER_LAMBDA_FN
+            {
+                if (tok == "blocking")
+                {
+                    mLatchMode = LatchMode_Blocking;
+                }
+                else if (tok == "reproject")
+                {
+                    mLatchMode = LatchMode_Reproject;
+                }
+                else
+                {
+                    return ParseStatus_BadVal;
+                }
+
+                return ParseStatus_Success;
+            });
+
+        AddOption("array-swapchain", "asc", false, "Render both eyes into a single two-layer texture array swapchain",
+            HANDLER_LAMBDA_FN{ mArraySwapchain = true; return ParseStatus_Success; });
+
+        AddOption("frame-timing-csv", "ftc", false, "Write the last several seconds of per-frame latch/blit/submit timings to a csv in the log folder when rendering stops",
+            HANDLER_LAMBDA_FN{ mFrameTimingCsv = true; return ParseStatus_Success; });
+
+        AddOption("stats-hud", "hud", false, "Show fps, bitrate, latency and repeated/missed frames on a small panel in the headset, redrawn once a second as its own compositor layer",
+            HANDLER_LAMBDA_FN{ mStatsHud = true; return ParseStatus_Success; });
+
+        AddOption("stats-summary", "ss", true, "Sample connection stats in the background and write latency/fps/bitrate/loss percentiles to the log folder every given seconds [1-3600], plus a session summary.  0 disables.",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t secs = -1;
+                std::stringstream ss(tok); ss >> secs;
+                if (secs >= 0 && secs <= 3600)
+                {
+                    mStatsSummarySec = secs;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("input-deadband", "idb", true, "Ignore analog trigger/stick changes smaller than this from the last sent value, and snap to rest within it. [0-0.25]",
+            HANDLER_LAMBDA_FN
+            {
+                float db = -1;
+                std::stringstream ss(tok); ss >> db;
+                if (db >= 0.0f && db <= 0.25f)
+                {
+                    mInputDeadband = db;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("input-quantize", "iq", true, "Quantize analog trigger/stick values to the given number of steps over their range [2-65535].  0 disables.",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t steps = -1;
+                std::stringstream ss(tok); ss >> steps;
+                if (steps == 0 || (steps >= 2 && steps <= 65535))
+                {
+                    mInputQuantize = steps;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("input-axis-rate", "iar", true, "Send each analog trigger/stick axis at most this many times a second [1-1000].  Rest positions always go out immediately.  0 is unlimited.",
+            HANDLER_LAMBDA_FN
+            {
+                float hz = -1;
+                std::stringstream ss(tok); ss >> hz;
+                if (hz == 0.0f || (hz >= 1.0f && hz <= 1000.0f))
+                {
+                    mInputAxisRate = hz;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("audio-latency-min", "alm", true, "Lowest depth in ms the audio jitter buffer aims for, it grows from here with measured jitter. [5-500]",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t ms = -1;
+                std::stringstream ss(tok); ss >> ms;
+                if (ms >= 5 && ms <= 500)
+                {
+                    mAudioLatencyMinMs = ms;
+                    if (mAudioLatencyMaxMs < mAudioLatencyMinMs)
+                        mAudioLatencyMaxMs = mAudioLatencyMinMs;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("audio-latency-max", "alx", true, "Deepest the audio jitter buffer may grow to in ms. [5-500]",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t ms = -1;
+                std::stringstream ss(tok); ss >> ms;
+                if (ms >= 5 && ms <= 500)
+                {
+                    mAudioLatencyMaxMs = ms;
+                    if (mAudioLatencyMinMs > mAudioLatencyMaxMs)
+                        mAudioLatencyMinMs = mAudioLatencyMaxMs;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("mic-frame-ms", "mfm", true, "Size in ms of the microphone packets sent to the server, to match the voice encoder frame. [5|10|20|40|60]",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t ms = -1;
+                std::stringstream ss(tok); ss >> ms;
+                if (ms == 5 || ms == 10 || ms == 20 || ms == 40 || ms == 60)
+                {
+                    mMicFrameMs = ms;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("quality-governor", "qg", false, "Step refresh, foveation, resolution and bitrate down while connection quality reports high latency or low bandwidth, and back up once it recovers.  Refresh changes live, the rest on the next connect.",
+            HANDLER_LAMBDA_FN{ mQualityGovernor = true; return ParseStatus_Success; });
+
+        AddOption("clock-governor", "cg", false, "Adjust CPU/GPU clock levels at runtime to the lowest that holds the display rate, backing off when the device runs hot or low on battery.  Bounds come from -cpu-levels/-gpu-levels.",
+            HANDLER_LAMBDA_FN{ mClockGovernor = true; return ParseStatus_Success; });
+
+        AddOption("cpu-levels", "cpul", true, "CPU clock level range for the clock governor, as min-max or a single fixed level. [0-9]",
+            HANDLER_LAMBDA_FN { return ParseLevelRange(tok, mCpuLevelMin, mCpuLevelMax); });
+
+        AddOption("gpu-levels", "gpul", true, "GPU clock level range for the clock governor, as min-max or a single fixed level. [0-9]",
+            HANDLER_LAMBDA_FN { return ParseLevelRange(tok, mGpuLevelMin, mGpuLevelMax); });
+
+        AddOption("warm-suspend", "ws", true, "On pause, keep the server session, swapchains and device setup for up to this many seconds so resuming skips a reconnect [1-600].  0 always tears down.",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t secs = -1;
+                std::stringstream ss(tok); ss >> secs;
+                if (secs >= 0 && secs <= 600)
+                {
+                    mWarmSuspendS = secs;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("server-probes", "sp", true, "Connection probes sent to each candidate server when given several [1-50]",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t probes = -1;
+                std::stringstream ss(tok); ss >> probes;
+                if (probes >= 1 && probes <= 50)
+                {
+                    mServerProbes = probes;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("control-socket", "cs", true, "Accept option updates while running on the given abstract local socket, for use with adb forward tcp:<port> localabstract:<name>",
+            HANDLER_LAMBDA_FN { mControlSocket = tok; return ParseStatus_Success; });
+
+        AddOption("log-level", "ll", true, "Log level for both the log file and logcat, overrides verbose and quiet. [silence|error|warning|info|debug|verbose]",
+            HANDLER_LAMBDA_FN
+            {
+                static const char* levels[] = { "silence", "error", "warning", "info", "debug", "verbose" };
+                static const cxrLogLevel values[] = { cxrLL_Silence, cxrLL_Error, cxrLL_Warning, cxrLL_Info, cxrLL_Debug, cxrLL_Verbose };
+                for (uint32_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++)
+                {
+                    if (tok == levels[i])
+                    {
+                        mLogLevel = values[i];
+                        return ParseStatus_Success;
+                    }
+                }
+                return ParseStatus_BadVal;
+            });
+
+        AddOption("tracking-record", "trec", false, "Record tracking and controller input while streaming to a .cxrt file in the log folder, for use with -tracking-replay",
+            HANDLER_LAMBDA_FN{ mTrackingRecord = true; return ParseStatus_Success; });
+
+        AddOption("tracking-replay", "trep", true, "Stream from a recorded .cxrt file instead of the headset and controllers, then exit.  Relative paths are under the log folder",
+            HANDLER_LAMBDA_FN { mTrackingReplay = tok; return ParseStatus_Success; });
+
         AddOption("network-interface-client", "nic", true, "Choose client network inteface. [ethernet|wifi5ghz|wifi24ghz|mobilelte|mobile5g]",
             HANDLER_LAMBDA_FN
             {
@@ -306,6 +675,26 @@ public:
     {
         ParseArgs(argc, argv);
     }
+
+private:
+    // "min-max", or a single level for both.
+    static ParseStatus ParseLevelRange(const std::string& tok, int32_t& minOut, int32_t& maxOut)
+    {
+        int32_t lo = -1, hi = -1;
+        char dash = 0;
+        std::stringstream ss(tok);
+        if (!(ss >> lo))
+            return ParseStatus_BadVal;
+        if (!(ss >> dash))
+            hi = lo;
+        else if (dash != '-' || !(ss >> hi))
+            return ParseStatus_BadVal;
+        if (lo < 0 || hi > 9 || lo > hi)
+            return ParseStatus_BadVal;
+        minOut = lo;
+        maxOut = hi;
+        return ParseStatus_Success;
+    }
 };
 
 }; // namespace CloudXR
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_CLOCK_GOVERNOR_H
+#define CLOUDXR_CLOCK_GOVERNOR_H
+
+#include <atomic>
+#include <math.h>
+#include <stdint.h>
+
+// Picks CPU/GPU clock levels: the lowest pair that holds the display rate.
+// The render thread reports every frame; once a window the owner calls
+// Evaluate with the device's thermal and battery state, which returns whether
+// the levels should change.
+//
+// Missed frames in a window raise one level, the GPU one if our own GPU work
+// was heavy, otherwise the CPU one.  Enough clean, light windows in a row step
+// the higher level down.  Misses soon after a step down put it back and hold
+// that floor a while, so we don't probe the same too-low level every few
+// seconds.  Thermal throttling or a hot battery steps levels down whatever the
+// frames say, and a low battery caps them just above the minimums.
+class cxrClockGovernor
+{
+public:
+    static constexpr double WindowS = 1.0;
+    static constexpr uint32_t CleanWindowsToLower = 10;
+    static constexpr double RetreatWindowS = 15.0;      // misses this soon after a step down undo it.
+    static constexpr double FloorHoldS = 60.0;          // and keep that floor this long.
+    static constexpr double ThermalStepS = 10.0;        // how often heat steps us down.
+    static constexpr float HeavyWorkFraction = 0.5f;    // of the display period.
+    static constexpr float LightWorkFraction = 0.3f;
+    static constexpr float HotBatteryC = 42.0f;
+    static constexpr int32_t LowBatteryPct = 15;
+
+    struct Device
+    {
+        bool throttled;
+        int32_t batteryPct;     // < 0 if unknown
+        float batteryTempC;     // < -100 if unknown
+    };
+
+    void Configure(int32_t cpuMin, int32_t cpuMax, int32_t gpuMin, int32_t gpuMax)
+    {
+        m_min[0] = cpuMin; m_max[0] = cpuMax;
+        m_min[1] = gpuMin; m_max[1] = gpuMax;
+        Reset();
+    }
+
+    // back to the minimums, e.g. on entering vr mode.
+    void Reset()
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            m_level[i] = m_min[i];
+            m_floor[i] = m_min[i];
+        }
+        m_cleanWindows = 0;
+        m_lastLowerS = 0;
+        m_lowered = -1;
+        m_floorUntilS = 0;
+        m_lastThermalS = 0;
+        m_frames = m_missed = m_timed = m_heavy = m_light = 0;
+        m_renderReset.store(true, std::memory_order_release); // AddFrame drops its own state.
+    }
+
+    int32_t CpuLevel() const { return m_level[0]; }
+    int32_t GpuLevel() const { return m_level[1]; }
+
+    // render thread, once per submitted frame.  workMs is our own GPU-bound
+    // render work for the frame, not time spent waiting on the stream, < 0 if
+    // it wasn't measured, which counts the frame for misses only.
+    void AddFrame(double displayTimeS, double periodS, float workMs)
+    {
+        if (m_renderReset.load(std::memory_order_relaxed) &&
+            m_renderReset.exchange(false, std::memory_order_acquire))
+            m_lastDisplayTimeS = 0;
+
+        // a long gap is a pause or a restarted render loop, not dropped frames.
+        if (m_lastDisplayTimeS > 0 && periodS > 0 && displayTimeS - m_lastDisplayTimeS < 0.5)
+        {
+            const double gap = (displayTimeS - m_lastDisplayTimeS) / periodS;
+            if (gap > 1.5)
+                m_missed.fetch_add((uint32_t)(gap - 0.5), std::memory_order_relaxed);
+        }
+        m_lastDisplayTimeS = displayTimeS;
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+        if (workMs < 0)
+            return;
+
+        m_timed.fetch_add(1, std::memory_order_relaxed);
+        const float fraction = (float)(workMs / (periodS * 1000.0));
+        if (fraction > HeavyWorkFraction)
+            m_heavy.fetch_add(1, std::memory_order_relaxed);
+        else if (fraction < LightWorkFraction)
+            m_light.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // owner thread, once per WindowS.  returns true if the levels changed.
+    bool Evaluate(double nowS, const Device& device)
+    {
+        const uint32_t frames = m_frames.exchange(0, std::memory_order_relaxed);
+        const uint32_t missed = m_missed.exchange(0, std::memory_order_relaxed);
+        const uint32_t timed = m_timed.exchange(0, std::memory_order_relaxed);
+        const uint32_t heavy = m_heavy.exchange(0, std::memory_order_relaxed);
+        const uint32_t light = m_light.exchange(0, std::memory_order_relaxed);
+        if (frames == 0)
+            return false; // not rendering, nothing to judge.
+
+        const int32_t before[2] = { m_level[0], m_level[1] };
+
+        // the ceiling the device will let us have right now.
+        int32_t cap[2] = { m_max[0], m_max[1] };
+        if (device.batteryPct >= 0 && device.batteryPct < LowBatteryPct)
+        {
+            for (int i = 0; i < 2; ++i)
+                cap[i] = (m_min[i] + 1 < m_max[i]) ? m_min[i] + 1 : m_max[i];
+        }
+
+        const bool hot = device.throttled || device.batteryTempC >= HotBatteryC;
+        if (hot)
+        {
+            if (nowS - m_lastThermalS >= ThermalStepS)
+            {
+                m_lastThermalS = nowS;
+                const int i = (m_level[1] - m_min[1] >= m_level[0] - m_min[0]) ? 1 : 0;
+                if (m_level[i] > m_min[i])
+                    m_level[i]--;
+            }
+            m_cleanWindows = 0;
+        }
+        else if (missed > 1) // a single miss is usually a hiccup elsewhere.
+        {
+            m_cleanWindows = 0;
+            if (m_lowered >= 0 && nowS - m_lastLowerS < RetreatWindowS)
+            {
+                // that step down was one too many, go back and stay there.
+                m_level[m_lowered]++;
+                m_floor[m_lowered] = m_level[m_lowered];
+                m_floorUntilS = nowS + FloorHoldS;
+                m_lowered = -1;
+            }
+            else
+            {
+                const int i = (heavy * 4 > timed) ? 1 : 0;
+                if (m_level[i] < cap[i])
+                    m_level[i]++;
+                else if (m_level[1 - i] < cap[1 - i])
+                    m_level[1 - i]++;
+            }
+        }
+        else if (missed == 0 && timed > 0 && light * 10 >= timed * 9)
+        {
+            if (++m_cleanWindows >= CleanWindowsToLower)
+            {
+                m_cleanWindows = 0;
+                if (nowS >= m_floorUntilS)
+                {
+                    m_floor[0] = m_min[0];
+                    m_floor[1] = m_min[1];
+                }
+
+                // lower whichever sits further above its floor.
+                const int i = (m_level[1] - m_floor[1] >= m_level[0] - m_floor[0]) ? 1 : 0;
+                if (m_level[i] > m_floor[i])
+                {
+                    m_level[i]--;
+                    m_lowered = i;
+                    m_lastLowerS = nowS;
+                }
+            }
+        }
+        else
+        {
+            m_cleanWindows = 0;
+        }
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (m_level[i] > cap[i]) m_level[i] = cap[i];
+            if (m_level[i] < m_min[i]) m_level[i] = m_min[i];
+        }
+        m_lastMissed = missed;
+        m_lastFrames = frames;
+        return m_level[0] != before[0] || m_level[1] != before[1];
+    }
+
+    // from the window Evaluate just judged, for logging.
+    uint32_t LastMissed() const { return m_lastMissed; }
+    uint32_t LastFrames() const { return m_lastFrames; }
+
+private:
+    int32_t m_min[2] = { 0, 0 };
+    int32_t m_max[2] = { 0, 0 };
+    int32_t m_level[2] = { 0, 0 };
+    int32_t m_floor[2] = { 0, 0 };
+
+    // owner only
+    uint32_t m_cleanWindows = 0;
+    double m_lastLowerS = 0;
+    int m_lowered = -1;         // which level the last step down was on, -1 none pending.
+    double m_floorUntilS = 0;
+    double m_lastThermalS = 0;
+    uint32_t m_lastMissed = 0;
+    uint32_t m_lastFrames = 0;
+
+    // render thread only, cleared there when Reset sets m_renderReset.
+    double m_lastDisplayTimeS = 0;
+    std::atomic<bool> m_renderReset{false};
+
+    std::atomic<uint32_t> m_frames{0};
+    std::atomic<uint32_t> m_missed{0};
+    std::atomic<uint32_t> m_timed{0};   // frames with a measured workMs.
+    std::atomic<uint32_t> m_heavy{0};
+    std::atomic<uint32_t> m_light{0};
+};
+
+#endif // CLOUDXR_CLOCK_GOVERNOR_H
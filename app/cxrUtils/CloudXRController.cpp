@@ -73,12 +73,9 @@ void CloudXRController::UpdatePose(const cxrControllerTrackingState& state, floa
         else
         {
             // The driver interface expects angular velocity in device space. Transform to that, if the angular velocity is in world space.
-            cxrVector3 zero = { 0, 0, 0 };
-            cxrMatrix34 poseMatrix;
-            cxrVecQuatToMatrix(&zero, &pose.rotation, &poseMatrix);
-            cxrMatrix34 invert;
-            cxrInverseMatrix(&poseMatrix, &invert);
-            cxrTransformVector(&invert, &pose.angularVelocity, &vAngularVelocity);
+            // rotating by the conjugate is the inverse rotation, no need for the matrix round trip.
+            const cxrQuaternion inverse = cxrQuatConjugate(&pose.rotation);
+            cxrQuatRotateVector(&inverse, &pose.angularVelocity, &vAngularVelocity);
         }
 
         for (int i = 0; i < 3; i++)
@@ -143,7 +140,7 @@ void CloudXRController::SetServerActions(uint32_t count, const char* actionPaths
 }
 
 // TODO: in future, we may want AddProfile, to add a bunch, then SetProfile takes an index or name.
-void CloudXRController::SetProfile(std::map<std::string, std::string> profile)
+void CloudXRController::SetProfile(const std::map<std::string, std::string>& profile)
 {
     m_actionMap.BindProfile(profile);
 }
@@ -159,7 +156,7 @@ void CloudXRController::HandleModernEvents(std::vector<cxrActionEvent> &serverQu
         // this is the client-side index for a given input path/string.
         uint16_t clientIndex = e.clientInputIndex; // TODO this will update to inputIndex at some point
 
-        if(m_actionMap.m_clientInputDatatypes[clientIndex] != e.inputValue.valueType)
+        if (!m_actionMap.IsInputType(clientIndex, e.inputValue.valueType))
         { // This is a sanity check that should never occur, right?
             CXR_LOGE("Error: m_clientInputTypes mismatch!");
             continue;
@@ -169,12 +166,11 @@ void CloudXRController::HandleModernEvents(std::vector<cxrActionEvent> &serverQu
         if (ai == 0) // 0==invalid, no binding for that client input
             continue;
 
-        cxrActionEvent newEvent = {};
+        // I think all we need to do is push onto server queue now...
+        serverQueue.emplace_back();
+        cxrActionEvent& newEvent = serverQueue.back();
         newEvent.actionIndex = ai;
         newEvent.clientEvent = e; // just let C copy the struct over, since we want value passed as-is.
-        
-        // I think all we need to do is push onto server queue now...
-        serverQueue.push_back(newEvent);
     }
 }
 
@@ -182,24 +178,24 @@ void CloudXRController::HandleModernEvents(std::vector<cxrActionEvent> &serverQu
 void cxrControllerInputActionMap::RegisterClientInputs(uint32_t count, const char *paths[], const cxrInputValueType types[])
 {
     m_clientInputPaths.clear();
-    m_clientInputDatatypes.clear();
+    m_clientInputDatatypes.assign(types, types + count);
+    // client indices changed, so any compiled profile is stale until bound again.
+    m_inputToActionRemap.assign(count, 0);
 
     for (uint32_t i = 0; i < count; ++i)
     {
         m_clientInputPaths.insert(std::map<std::string, uint32_t>::value_type(paths[i], i));
-        m_clientInputDatatypes.insert(std::map<uint32_t, cxrInputValueType>::value_type(i, types[i]));
     }
 }
 
 void cxrControllerInputActionMap::RegisterServerInputs(uint32_t count, const char *inputPaths[], const cxrInputValueType inputTypes[])
 {
     m_serverInputPaths.clear();
-    m_serverInputDatatypes.clear();
+    m_serverInputDatatypes.assign(inputTypes, inputTypes + count);
 
     for (uint32_t i = 0; i < count; ++i)
     {
         m_serverInputPaths.insert(std::map<std::string, uint32_t>::value_type(inputPaths[i], i));
-        m_serverInputDatatypes.insert(std::map<uint32_t, cxrInputValueType>::value_type(i, inputTypes[i]));
 
         // we build client->server index remap here, as it's much lower O() count here then as a sep pass...
         auto clientIt = m_clientInputPaths.find(inputPaths[i]);
@@ -225,11 +221,12 @@ void cxrControllerInputActionMap::RegisterActions(uint32_t count, const char *ac
     }
 }
 
-void cxrControllerInputActionMap::BindProfile(std::map<std::string, std::string> profile)
+void cxrControllerInputActionMap::BindProfile(const std::map<std::string, std::string>& profile)
 {
     m_actionProfile.clear(); // we're going to build by hand, in case of any bad bindings.
-    m_inputToActionRemap.clear();
-    for (auto binding : profile)
+    // one slot per client input, so translating an event is a single index.
+    m_inputToActionRemap.assign(m_clientInputDatatypes.size(), 0);
+    for (const auto& binding : profile)
     {
         // find the path mappings, both to get indices, and to sanity check this is a usable binding.
         auto clientIt = m_clientInputPaths.find(binding.first);
@@ -262,21 +259,10 @@ void cxrControllerInputActionMap::BindProfile(std::map<std::string, std::string>
 
         uint32_t serverActionIndex = actIt->second;
         // then combine client index -> server action enum.  this does the 'heavy lifting' in one go.
-        m_inputToActionRemap.insert(std::map<uint32_t, uint32_t>::value_type(clientIndex, serverActionIndex));
+        m_inputToActionRemap[clientIndex] = serverActionIndex;
 
         // and we can add to our internal copy of profile with bindings that were okay for this device.
         m_actionProfile.insert(std::map<std::string, std::string>::value_type(binding.first, binding.second));
 
     }
 }
-
-// return action index if in remap table, otherwise return 0 which means no action.
-uint32_t cxrControllerInputActionMap::GetActionIndex(uint32_t clientInputIndex)
-{
-    auto actIt = m_inputToActionRemap.find(clientInputIndex);
-    if (actIt != m_inputToActionRemap.end())
-    {
-        return actIt->second;
-    }
-    return 0;
-}
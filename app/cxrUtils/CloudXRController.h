@@ -67,12 +67,21 @@ public:
     
     // fn needed here to register the profile for this controller remap
     // given this is pre-constructed remap table, passing in map<inputPath, actionPath>
-    // and it will make map<clientInputIndex, actionIndex> from server list, client list, and action list.
-    void BindProfile(std::map<std::string, std::string> profile);
+    // and it will compile a dense clientInputIndex -> actionIndex table from server list, client list, and action list.
+    void BindProfile(const std::map<std::string, std::string>& profile);
 
     // this does the lookup/translation from client input index all the way to the server action
     // note that index 0 is reserved for kNoActionMapped value.
-    uint32_t GetActionIndex(uint32_t inputIndex);
+    uint32_t GetActionIndex(uint32_t inputIndex) const
+    {
+        return (inputIndex < m_inputToActionRemap.size()) ? m_inputToActionRemap[inputIndex] : 0;
+    }
+
+    // true if the client registered this input index with this value type.
+    bool IsInputType(uint32_t inputIndex, cxrInputValueType type) const
+    {
+        return inputIndex < m_clientInputDatatypes.size() && m_clientInputDatatypes[inputIndex] == type;
+    }
 
 private:
     // there are certainly better ways to do this.
@@ -80,16 +89,19 @@ private:
     // Load them up one by one, and do resolves to secondary maps when ready.
     // At the end, a given ActionMap could be similar to OpenXR ActionSet
 
+    // The string maps are only used while registering and binding.  Anything looked
+    // up per event is a vector addressed directly by index.
+
     // server will 'prefill' these maps at init, as they should be statics in the server.
     // they don't change at all at runtime, so server should own canonical form.
     // whether these three turn into pointers or references to server-equiv maps is TBD.
     std::map<std::string, uint32_t> m_serverInputPaths; // server global list of inputpaths -> server index
-    std::map<uint32_t, cxrInputValueType> m_serverInputDatatypes; // server global list of input data type per server index (per inputpath)
+    std::vector<cxrInputValueType> m_serverInputDatatypes; // server global list of input data type per server index (per inputpath)
     std::map<std::string, uint32_t> m_serverActionPaths; // server actionpath -> server actionindex
 
     // client sends/registers this with server on connection of given controller.
     std::map<std::string, uint32_t> m_clientInputPaths; // client inputpath -> client index
-    std::map<uint32_t, cxrInputValueType> m_clientInputDatatypes; // client index -> client sent data type for this input.
+    std::vector<cxrInputValueType> m_clientInputDatatypes; // client index -> client sent data type for this input.
 
     // this is constructed based on server/app profile for a given controller,
     // mapping input strings to action strings.  It is then used to build other remap tables.
@@ -97,7 +109,7 @@ private:
 
     // if profile changes, we need to rebuild this.  Or we should have a vector if we have a profile vector,
     // so switching profiles would switch which Remap we use for translations.
-    std::map<uint32_t, uint32_t> m_inputToActionRemap; // client inputindex -> server actionindex
+    std::vector<uint32_t> m_inputToActionRemap; // client inputindex -> server actionindex, 0 if unbound.
 };
 
 class CloudXRController
@@ -108,7 +120,7 @@ public:
 
     void SetServerInputs(uint32_t count, const char* inputPaths[], const cxrInputValueType inputTypes[]);
     void SetServerActions(uint32_t count, const char* actionPaths[]);
-    void SetProfile(std::map<std::string, std::string> profile);
+    void SetProfile(const std::map<std::string, std::string>& profile);
 
     void Update(const cxrControllerTrackingState & state, float timeOffset);
     void UpdatePose(const cxrControllerTrackingState & state, float timeOffset);
@@ -47,6 +47,12 @@ using std::string;
 #include <sys/stat.h>
 #endif
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+#include <algorithm>
+
 #include <stdarg.h>
 #include <errno.h>
 
@@ -91,9 +97,7 @@ void FileLogger::init(const std::string &appOutputPath, std::string &filenamePre
         t.wSecond);
     m_suffix = std::string(suffix);
 
-    char filePath[MAX_PATH];
-    sprintf_s(filePath, "%s\\%s Log %s.txt",
-        logDir.c_str(), filenamePrefix.c_str(), suffix);
+    m_logFileBase = logDir + "\\" + filenamePrefix + " Log " + m_suffix;
 
 #elif defined (__linux__) || defined (__APPLE__)
     time_t t;
@@ -107,9 +111,11 @@ void FileLogger::init(const std::string &appOutputPath, std::string &filenamePre
         tmptr->tm_mday, tmptr->tm_hour, tmptr->tm_min, tmptr->tm_sec);
     m_suffix = std::string(suffix);
 
-    char filePath[MAX_PATH];
-    sprintf(filePath, "%s/%s Log %s.txt", logDir.c_str(), filenamePrefix.c_str(), suffix);
+    m_logFileBase = logDir + "/" + filenamePrefix + " Log " + m_suffix;
 #endif
+    const std::string filePath = segmentPath(0);
+    m_segmentIndex = 0;
+    m_segmentBytes = 0;
 
     if (!MakePathDirs(logDir))
     {
@@ -117,10 +123,10 @@ void FileLogger::init(const std::string &appOutputPath, std::string &filenamePre
         debugOut(cxrLL_Error, "FileLogger::Init", "Failed to make output path: %s", logDir.c_str());
     }
 
-    m_logFile = fopen(filePath, "wb");
+    m_logFile = fopen(filePath.c_str(), "wb");
     if (!m_logFile)
     {
-        debugOut(cxrLL_Error, "FileLogger::Init", "Err #%s opening log file: %s. File logging disabled but still writing to debug output.", strerror(errno), filePath);
+        debugOut(cxrLL_Error, "FileLogger::Init", "Err #%s opening log file: %s. File logging disabled but still writing to debug output.", strerror(errno), filePath.c_str());
     }
 
     const char* infoMsg = "File logger for CloudXR SDK " CLOUDXR_VERSION ", built on " __DATE__ " " __TIME__ ".\n";
@@ -142,12 +148,21 @@ void FileLogger::init(const std::string &appOutputPath, std::string &filenamePre
     vlog("Android OS sdk version level is %s", propStr);
 #endif
 
+    if (m_prunedLogs > 0)
+        vlog("Pruned %d old log files from %s", m_prunedLogs, logDir.c_str());
+
     // dump any messages attempted to log prior to init.
     processMsgQueue();
+
+    // from here on, file writes move off the logging threads.
+    if (m_async && m_logFile)
+        startAsyncWriter();
 }
 
 void FileLogger::destroy()
 {
+    stopAsyncWriter(); // drains anything still queued.
+
     m_loggerMutex.lock();
     if (m_logFile)
     {
@@ -297,6 +312,19 @@ void FileLogger::reallyLog(cxrLogLevel ll, const char *tag, bool writeToFile, co
 
     if (!m_init)
         enqueueMsgBuffer(debug);
+    else if (m_asyncRunning)
+    {
+        // errors get the writer up right away, so they're on disk if we go down after.
+        // a ring filling in a burst does too, rather than waiting out the timer.
+        const bool urgent = (ll >= cxrLL_Error);
+        bool busy = false;
+        m_asyncRing->Push(debug, strlen(debug), urgent, &busy);
+        if (urgent || busy)
+        {
+            m_asyncFlushRequested = true;
+            m_asyncWake.notify_one();
+        }
+    }
     else
         writeBufferToFile(debug);
 }
@@ -312,28 +340,70 @@ void FileLogger::writeBufferToFile(const char* buf)
 
     // print message to logfile.
     fputs(buf, m_logFile);
+    m_segmentBytes += strlen(buf);
     if (m_logLevel > 0)
     {
         fflush(m_logFile);
     }
 
-    if (m_logMaxSizeKB > 0)
+    rotateIfFull();
+
+    m_loggerMutex.unlock();
+}
+
+std::string FileLogger::segmentPath(uint32_t index) const
+{
+    if (index == 0)
+        return m_logFileBase + ".txt"; // first segment keeps the name logs always had.
+
+    char seg[32]; // room for any uint32_t index.
+    snprintf(seg, sizeof(seg), " seg%03u.txt", index);
+    return m_logFileBase + seg;
+}
+
+void FileLogger::rotateIfFull()
+{
+    if (m_logMaxSizeKB == 0 || !m_logFile)
+        return;
+
+    const uint64_t segmentCap = (uint64_t)m_logMaxSizeKB * 1024 / c_logSegments;
+    if (m_segmentBytes < segmentCap)
+        return;
+
+    fputs("Log continues in next segment.\n", m_logFile);
+    fclose(m_logFile);
+
+    // segment 0 has the session header, so only later segments roll over.
+    m_segmentIndex++;
+    if (m_segmentIndex >= c_logSegments)
+        remove(segmentPath(m_segmentIndex - (c_logSegments - 1)).c_str());
+
+    const std::string path = segmentPath(m_segmentIndex);
+    m_logFile = fopen(path.c_str(), "wb");
+    m_segmentBytes = 0;
+    if (!m_logFile)
     {
-        // we cap logs file to a given KB size, assuming early lines are most important.
-        long file_size = ftell(m_logFile);
-        if ((file_size > 0) && ((uint32_t)file_size / 1024 >= m_logMaxSizeKB))
-        {
-            fputs("Reached the log file size limit.", m_logFile);
-            fclose(m_logFile);
-            m_logFile = NULL;
-        }
+        debugOut(cxrLL_Error, "FileLogger", "Err #%s opening log segment: %s. File logging disabled.", strerror(errno), path.c_str());
+        return;
     }
 
-    m_loggerMutex.unlock();
+    char header[128];
+    const int len = snprintf(header, sizeof(header), "Log segment %u, kept alongside segment 0 and up to %u others.\n",
+                             m_segmentIndex, c_logSegments - 2);
+    fputs(header, m_logFile);
+    m_segmentBytes += (len > 0) ? len : 0;
 }
 
 void FileLogger::flush()
 {
+    if (m_asyncRunning)
+    {
+        // queued lines are the writer's, it flushes once they're out.
+        m_asyncFlushRequested = true;
+        m_asyncWake.notify_one();
+        return;
+    }
+
     m_loggerMutex.lock();
     if (m_logFile)
     {
@@ -342,6 +412,194 @@ void FileLogger::flush()
     m_loggerMutex.unlock();
 }
 
+void FileLogger::startAsyncWriter()
+{
+    if (!m_asyncRing)
+        m_asyncRing.reset(new cxrLogRing(c_asyncRingSlots));
+    if (!m_recordRing)
+    {
+        m_recordRing.reset(new cxrLogRing(c_asyncRingSlots));
+        m_recordPending.resize(c_asyncBatchBytes + CXR_LOG_RECORD_MAX);
+        m_recordPendingLen = 0;
+    }
+
+    m_asyncRunning = true;
+    m_asyncThread = std::thread([this]() { asyncWriterLoop(); });
+}
+
+void FileLogger::stopAsyncWriter()
+{
+    if (!m_asyncThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        m_asyncRunning = false;
+    }
+    m_asyncWake.notify_one();
+    m_asyncThread.join();
+
+    // a thread that saw us running just before the stop may have pushed after the
+    // writer's last drain, so catch that here.  the rings themselves live as long
+    // as we do, for the same reason.
+    std::vector<char> batch(c_asyncBatchBytes);
+    drainAsync(batch);
+}
+
+void FileLogger::asyncWriterLoop()
+{
+    std::vector<char> batch(c_asyncBatchBytes); // allocated once, reused for every drain.
+    bool stopping = false;
+
+    while (!stopping)
+    {
+        {
+            // a notify racing the predicate check only costs us one timer period.
+            std::unique_lock<std::mutex> lock(m_asyncMutex);
+            m_asyncWake.wait_for(lock, std::chrono::milliseconds((int64_t)c_asyncFlushMs),
+                [this]() { return m_asyncFlushRequested || !m_asyncRunning; });
+            stopping = !m_asyncRunning;
+        }
+        m_asyncFlushRequested = false;
+
+        // loggers were stopped from writing before we were told to stop, so a final
+        // drain here gets everything.  the flush is every wakeup, so at most once per timer.
+        drainAsync(batch);
+    }
+}
+
+void FileLogger::drainAsync(std::vector<char>& batch)
+{
+    bool urgent = false;
+    size_t len;
+    while ((len = m_asyncRing->Drain(batch.data(), batch.size(), urgent)) > 0)
+        writeBatchToFile(batch.data(), len, false);
+
+#if CXR_LOG_DEFERRED_SUPPORTED
+    // records can straddle drains, so complete ones get formatted and the tail
+    // is carried over to the front for next time.
+    while ((len = m_recordRing->Drain(m_recordPending.data() + m_recordPendingLen,
+                                      m_recordPending.size() - m_recordPendingLen, urgent)) > 0)
+    {
+        m_recordPendingLen += len;
+
+        size_t pos = 0;
+        while (m_recordPendingLen - pos >= sizeof(cxrLogRecordHeader))
+        {
+            cxrLogRecordHeader header;
+            memcpy(&header, m_recordPending.data() + pos, sizeof(header));
+            if (m_recordPendingLen - pos < header.size)
+                break;
+            writeRecordLine(m_recordPending.data() + pos, header);
+            pos += header.size;
+        }
+        memmove(m_recordPending.data(), m_recordPending.data() + pos, m_recordPendingLen - pos);
+        m_recordPendingLen -= pos;
+    }
+#endif
+
+    const uint32_t dropped = m_asyncRing->TakeDropped() + m_recordRing->TakeDropped();
+    if (dropped > 0)
+    {
+        char msg[64];
+        const int msgLen = snprintf(msg, sizeof(msg), "[%u log lines dropped, writer fell behind]\n", dropped);
+        writeBatchToFile(msg, msgLen, false);
+    }
+
+    writeBatchToFile(nullptr, 0, true);
+}
+
+#if CXR_LOG_DEFERRED_SUPPORTED
+// Same line layout as reallyLog, but stamped with the time the record was made.
+void FileLogger::writeRecordLine(const void* record, const cxrLogRecordHeader& header)
+{
+    char msg[MAX_LOG_LINE_LEN];
+    cxrFormatLogRecord(record, msg, sizeof(msg));
+
+    char buffer[MAX_LOG_LINE_LEN];
+    snprintf(buffer, MAX_LOG_LINE_LEN, "%c  (%.*s)  %s", cxrLLToChar((cxrLogLevel)header.level),
+             MAX_TAG_LEN - 1, header.tag ? header.tag : "?", msg);
+
+    struct tm tm;
+    char prefix[32];
+    const time_t secs = (time_t)(header.timeNs / 1000000000LL);
+    gmtime_r(&secs, &tm);
+    strftime(prefix, 32, "%H:%M:%S", &tm);
+    char debug[MAX_LOG_LINE_LEN + 64];
+    const int len = snprintf(debug, MAX_LOG_LINE_LEN, "%s.%03ld %s\n", prefix,
+                             (long)((header.timeNs % 1000000000LL) / (1000L*1000L)), buffer);
+
+#if defined(ANDROID)
+    __android_log_print(cxrLLToAndroidPriority((cxrLogLevel)header.level), "CXR", "%s", buffer);
+#else
+    fputs(debug, stdout);
+#endif
+
+    if (len > 0)
+        writeBatchToFile(debug, strnlen(debug, sizeof(debug)), false);
+}
+#endif
+
+void FileLogger::logRecord(cxrLogLevel ll, const void* record, uint32_t size)
+{
+    if (m_asyncRunning && m_recordRing)
+    {
+        const bool urgent = (ll >= cxrLL_Error);
+        bool busy = false;
+        m_recordRing->Push((const char*)record, size, urgent, &busy);
+        if (urgent || busy)
+        {
+            m_asyncFlushRequested = true;
+            m_asyncWake.notify_one();
+        }
+        return;
+    }
+
+    // no writer to defer to, so format here like any other line.
+    cxrLogRecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    char msg[MAX_LOG_LINE_LEN];
+    cxrFormatLogRecord(record, msg, sizeof(msg));
+    reallyLog(ll, header.tag ? header.tag : "", true, msg);
+}
+
+void FileLogger::writeBatchToFile(const char* buf, size_t len, bool flush)
+{
+    m_loggerMutex.lock();
+
+    // a batch can be far bigger than a segment, so split it at a line break
+    // where the segment fills up rather than overshooting the cap.
+    const uint64_t segmentCap = (uint64_t)m_logMaxSizeKB * 1024 / c_logSegments;
+    while (m_logFile && len > 0)
+    {
+        size_t chunk = len;
+        if (segmentCap > 0 && m_segmentBytes + len > segmentCap)
+        {
+            const size_t room = (m_segmentBytes < segmentCap) ? (size_t)(segmentCap - m_segmentBytes) : 0;
+            size_t cut = room;
+            while (cut > 0 && buf[cut - 1] != '\n')
+                cut--;
+            if (cut == 0) // no break in the room left, finish the current line at least.
+            {
+                const char* nl = (const char*)memchr(buf, '\n', len);
+                cut = nl ? (size_t)(nl - buf) + 1 : len;
+            }
+            chunk = cut;
+        }
+
+        fwrite(buf, 1, chunk, m_logFile);
+        m_segmentBytes += chunk;
+        rotateIfFull();
+        buf += chunk;
+        len -= chunk;
+    }
+
+    if (m_logFile && flush)
+        fflush(m_logFile);
+
+    m_loggerMutex.unlock();
+}
+
 void FileLogger::enqueueMsgBuffer(const char *msg)
 {
     if (m_init) return; // queue only meant for pre-init at the moment.
@@ -467,9 +725,84 @@ std::string &FileLogger::getLogDir(const std::string outPath)
         // TODO: might want to verify once per run that the folder passed in,
         // or created above, is valid/accessible.  if we're hitting this block,
         // we've only just set m_logDir, so great time to validate or mkdirtree 
+
+        // and to clear out what earlier runs left, before we add to it.
+        pruneLogDir(m_logDir);
     }
 
     return m_logDir;
 }
 
+void FileLogger::pruneLogDir(const std::string &dir)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+        return; // likely doesn't exist yet, so nothing to prune.
+
+    struct OldLog
+    {
+        std::string path;
+        time_t mtime;
+        uint64_t size;
+    };
+    std::vector<OldLog> logs;
+
+    const time_t now = time(nullptr);
+    const time_t maxAge = (time_t)m_logMaxAgeDays * 24 * 60 * 60;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr)
+    {
+        // ours and the SDK's logs are all named [prefix] Log [suffix].txt
+        const std::string name = entry->d_name;
+        if (name.find(" Log ") == std::string::npos || name.size() < 4 ||
+            name.compare(name.size() - 4, 4, ".txt") != 0)
+            continue;
+
+        std::string path = dir;
+        if (path.back() != '/')
+            path += "/";
+        path += name;
+
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            continue;
+
+        if (m_logMaxAgeDays > 0 && now - st.st_mtime > maxAge)
+        {
+            if (remove(path.c_str()) == 0)
+                m_prunedLogs++;
+            continue;
+        }
+        logs.push_back({ path, st.st_mtime, (uint64_t)st.st_size });
+    }
+    closedir(d);
+
+    if (m_logMaxSizeKB == 0)
+        return;
+
+    // over budget, drop oldest first.
+    const uint64_t budget = (uint64_t)m_logMaxSizeKB * 1024 * c_logDirBudgetFactor;
+    uint64_t total = 0;
+    for (const OldLog& log : logs)
+        total += log.size;
+    if (total <= budget)
+        return;
+
+    std::sort(logs.begin(), logs.end(), [](const OldLog& a, const OldLog& b) { return a.mtime < b.mtime; });
+    for (const OldLog& log : logs)
+    {
+        if (total <= budget)
+            break;
+        if (remove(log.path.c_str()) == 0)
+        {
+            total -= log.size;
+            m_prunedLogs++;
+        }
+    }
+#else
+    (void)dir; // pruning is POSIX-only, elsewhere old logs are left alone.
+#endif
+}
+
 #endif
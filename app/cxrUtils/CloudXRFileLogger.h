@@ -30,6 +30,12 @@
 
 #include <mutex>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+
+#include "CloudXRLogRing.h"
 
 class FileLogger
 {
@@ -48,6 +54,15 @@ public:
     void enqueueMsgBuffer(const char *msg);
     void processMsgQueue();
 
+    // call before init.  when async, logging threads only copy the finished line
+    // into a ring, and a background thread batches it out to the file.
+    void setAsync(bool async) { m_async = async; }
+    bool isAsyncRunning() const { return m_asyncRunning; }
+
+    // deferred-format records, see CloudXRLogDeferred.h.  formatted on the async
+    // writer when it's running, otherwise right here.
+    void logRecord(cxrLogLevel ll, const void* record, uint32_t size);
+
     // this is a special helper that bypasses logfile, and ONLY emits to platform-specific debug output/console.
     // as a static method, it is also 100% safe to call at any time, doesn't require object
     static void debugOut(cxrLogLevel ll, const char *tag, const char *fmt, ...);
@@ -89,8 +104,48 @@ private:
 
     std::vector<std::string> m_preQueue;
 
-    // These variables are informative only, code to clean out
-    // directories of files is not included in this sample/helper.
+    // async writer state, only used when m_async was set before init.
+    void startAsyncWriter();
+    void stopAsyncWriter();
+    void asyncWriterLoop();
+    void drainAsync(std::vector<char>& batch);
+    void writeRecordLine(const void* record, const cxrLogRecordHeader& header);
+    void writeBatchToFile(const char* buf, size_t len, bool flush);
+
+    static const uint32_t c_asyncRingSlots = 2048; // x cxrLogRing::SlotBytes = 512KB
+    static const uint32_t c_asyncBatchBytes = 64 * 1024;
+    static const uint32_t c_asyncFlushMs = 250;
+
+    bool m_async = false;
+    std::unique_ptr<cxrLogRing> m_asyncRing;
+    std::unique_ptr<cxrLogRing> m_recordRing;
+    std::vector<char> m_recordPending; // writer only, records carried between drains.
+    size_t m_recordPendingLen = 0;
+    std::thread m_asyncThread;
+    std::mutex m_asyncMutex;
+    std::condition_variable m_asyncWake;
+    std::atomic<bool> m_asyncRunning{false};
+    std::atomic<bool> m_asyncFlushRequested{false};
+
+    // Session output is split into c_logSegments files of maxSizeKB/c_logSegments
+    // each.  Segment 0 holds the session header and is always kept; once full,
+    // the oldest of the later segments is deleted, so a long session stays under
+    // the cap but keeps its start and its most recent output.  Sizes are counted
+    // as we write, never asked of the file.
+    static const uint32_t c_logSegments = 4;
+    // old logs in the directory are pruned past max age, or oldest first once
+    // together they exceed this many times the per-session size cap.
+    static const uint32_t c_logDirBudgetFactor = 4;
+
+    std::string segmentPath(uint32_t index) const;
+    void rotateIfFull(); // with m_loggerMutex held.
+    void pruneLogDir(const std::string &dir);
+
+    std::string m_logFileBase; // [path]/[prefix] Log [suffix], segments append to this.
+    uint32_t m_segmentIndex = 0;
+    uint64_t m_segmentBytes = 0;
+    uint32_t m_prunedLogs = 0;
+
     const uint32_t c_defaultMaxAgeDays = 5;
     uint32_t m_logMaxAgeDays = c_defaultMaxAgeDays;
 
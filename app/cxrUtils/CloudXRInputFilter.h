@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_INPUT_FILTER_H
+#define CLOUDXR_INPUT_FILTER_H
+
+#include <math.h>
+#include <stdint.h>
+
+// Decides when an analog input has changed enough to be worth an event.
+// Raw trigger and stick values carry sensor noise, and sending every
+// difference costs bandwidth and server work for nothing.  Values are
+// quantized, snapped to rest/limit positions within the deadband, and then
+// compared against the last value actually SENT, so slow drift still gets
+// through once it adds up.  Rest and limit positions skip the rate limit so
+// releases are never delayed or lost.
+class cxrAnalogInputFilter
+{
+public:
+    // centered axes (sticks) also snap to zero.  minIntervalNS of 0 disables rate limiting.
+    void Configure(float minValue, float maxValue, bool centered,
+                   float deadband, uint32_t quantizeSteps, uint64_t minIntervalNS)
+    {
+        m_min = minValue;
+        m_max = maxValue;
+        m_centered = centered;
+        m_deadband = deadband;
+        m_step = quantizeSteps ? (maxValue - minValue) / quantizeSteps : 0.0f;
+        m_minIntervalNS = minIntervalNS;
+    }
+
+    // the state the server assumes before any event, so a connect starts from rest.
+    void Reset()
+    {
+        m_lastSent = m_centered ? 0.0f : m_min;
+        m_lastSentNS = 0;
+    }
+
+    // returns true with the value to send, or false if the change is filtered out.
+    bool Filter(float raw, uint64_t nowNS, float& out)
+    {
+        float v = raw < m_min ? m_min : (raw > m_max ? m_max : raw);
+        if (m_step > 0.0f)
+            v = m_min + roundf((v - m_min) / m_step) * m_step;
+
+        bool rest = false;
+        if (v - m_min <= m_deadband) { v = m_min; rest = true; }
+        else if (m_max - v <= m_deadband) { v = m_max; rest = true; }
+        else if (m_centered && fabsf(v) <= m_deadband) { v = 0.0f; rest = true; }
+
+        if (v == m_lastSent)
+            return false;
+        if (!rest)
+        {
+            if (fabsf(v - m_lastSent) < m_deadband)
+                return false;
+            if (m_minIntervalNS && nowNS - m_lastSentNS < m_minIntervalNS)
+                return false;
+        }
+
+        m_lastSent = v;
+        m_lastSentNS = nowNS;
+        out = v;
+        return true;
+    }
+
+    float LastSent() const { return m_lastSent; }
+
+private:
+    float m_min = 0.0f;
+    float m_max = 1.0f;
+    bool m_centered = false;
+    float m_deadband = 0.0f;
+    float m_step = 0.0f;
+    uint64_t m_minIntervalNS = 0;
+
+    float m_lastSent = 0.0f;
+    uint64_t m_lastSentNS = 0;
+};
+
+#endif // CLOUDXR_INPUT_FILTER_H
@@ -27,6 +27,9 @@
 
 #include "CloudXRCommon.h"
 #include <stdarg.h> // for vararg support
+#include <atomic>
+
+#include "CloudXRLogDeferred.h"
 
 #if defined(ANDROID)
 #include <android/log.h>
@@ -58,11 +61,57 @@ extern "C" inline int cxrLLToAndroidPriority(cxrLogLevel ll)
 // this to log via whatever method is desired.
 extern "C" void dispatchLogMsg(cxrLogLevel level, cxrMessageCategory category, void *extra, const char *tag, const char *fmt, ...);
 
-#define CXR_LOGE(format, ...) dispatchLogMsg(cxrLL_Error, cxrMC_Correctness, nullptr, LOG_TAG, format, ## __VA_ARGS__)
-#define CXR_LOGW(format, ...) dispatchLogMsg(cxrLL_Warning, cxrMC_Correctness, nullptr, LOG_TAG, format, ## __VA_ARGS__)
-#define CXR_LOGI(format, ...) dispatchLogMsg(cxrLL_Info, cxrMC_Correctness, nullptr, LOG_TAG, format, ## __VA_ARGS__)
-#define CXR_LOGD(format, ...) dispatchLogMsg(cxrLL_Debug, cxrMC_Correctness, nullptr, LOG_TAG, format, ## __VA_ARGS__)
-#define CXR_LOGV(format, ...) dispatchLogMsg(cxrLL_Verbose, cxrMC_Correctness, nullptr, LOG_TAG, format, ## __VA_ARGS__)
+// Runtime filter the macros check BEFORE any formatting or dispatch, so suppressed
+// messages cost a couple of relaxed loads.  The including binary also defines
+// this, next to dispatchLogMsg, and keeps it in step with its logger's level.
+struct cxrLogFilter
+{
+    std::atomic<int> minLevel{cxrLL_Verbose};
+    std::atomic<uint32_t> categoryMask{0xFFFFFFFF}; // bit per cxrMessageCategory
+    std::atomic<bool> deferred{false}; // route macros through cxrLogDeferred.
+};
+extern cxrLogFilter g_logFilter;
+
+inline bool cxrLogEnabled(cxrLogLevel ll, cxrMessageCategory mc)
+{
+    return (int)ll >= g_logFilter.minLevel.load(std::memory_order_relaxed) &&
+           (g_logFilter.categoryMask.load(std::memory_order_relaxed) & (1u << mc)) != 0;
+}
+
+#if CXR_LOG_DEFERRED_SUPPORTED
+#define CXR_LOG_EMIT(ll, mc, format, ...) \
+    do { \
+        if (cxrLogEnabled(ll, mc)) { \
+            if (g_logFilter.deferred.load(std::memory_order_relaxed)) \
+                cxrLogDeferred(ll, mc, LOG_TAG, format, ## __VA_ARGS__); \
+            else \
+                dispatchLogMsg(ll, mc, nullptr, LOG_TAG, format, ## __VA_ARGS__); \
+        } \
+    } while (0)
+#else
+#define CXR_LOG_EMIT(ll, mc, format, ...) \
+    do { if (cxrLogEnabled(ll, mc)) dispatchLogMsg(ll, mc, nullptr, LOG_TAG, format, ## __VA_ARGS__); } while (0)
+#endif
+
+// Compile-time floor: 1 strips CXR_LOGV, 2 strips CXR_LOGV and CXR_LOGD, arguments
+// and all.  Release builds can set it so chatty logging costs nothing at all.
+#ifndef CXR_LOG_COMPILE_FLOOR
+#define CXR_LOG_COMPILE_FLOOR 0
+#endif
+
+#define CXR_LOGE(format, ...) CXR_LOG_EMIT(cxrLL_Error, cxrMC_Correctness, format, ## __VA_ARGS__)
+#define CXR_LOGW(format, ...) CXR_LOG_EMIT(cxrLL_Warning, cxrMC_Correctness, format, ## __VA_ARGS__)
+#define CXR_LOGI(format, ...) CXR_LOG_EMIT(cxrLL_Info, cxrMC_Correctness, format, ## __VA_ARGS__)
+#if CXR_LOG_COMPILE_FLOOR >= 2
+#define CXR_LOGD(format, ...) do {} while (0)
+#else
+#define CXR_LOGD(format, ...) CXR_LOG_EMIT(cxrLL_Debug, cxrMC_Correctness, format, ## __VA_ARGS__)
+#endif
+#if CXR_LOG_COMPILE_FLOOR >= 1
+#define CXR_LOGV(format, ...) do {} while (0)
+#else
+#define CXR_LOGV(format, ...) CXR_LOG_EMIT(cxrLL_Verbose, cxrMC_Correctness, format, ## __VA_ARGS__)
+#endif
 
 // TEMPORARILY keeping older 'vlog' macros, just redirecting to new naming.
 // TODO: move these to an internal-only header if in fact they are only used in internal code.
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "CloudXRLogDeferred.h"
+
+namespace
+{
+    struct ArgReader
+    {
+        const uint8_t* pos;
+        const uint8_t* end;
+        uint32_t remaining;
+
+        bool Next(cxrLogArgType& type, const uint8_t*& payload, uint16_t& strLen)
+        {
+            if (remaining == 0 || pos >= end)
+                return false;
+            type = (cxrLogArgType)*pos++;
+            payload = pos;
+            switch (type)
+            {
+            case cxrLogArg_String:
+                memcpy(&strLen, pos, sizeof(strLen));
+                payload = pos + sizeof(strLen);
+                pos = payload + strLen;
+                break;
+            case cxrLogArg_Pointer:
+                pos += sizeof(const void*);
+                break;
+            default: // int, uint and double are all 8 bytes.
+                pos += sizeof(int64_t);
+                break;
+            }
+            remaining--;
+            return pos <= end;
+        }
+
+        // for '*' width/precision, which printf takes as an int argument.
+        int NextInt()
+        {
+            cxrLogArgType type;
+            const uint8_t* payload;
+            uint16_t len;
+            int64_t value = 0;
+            if (Next(type, payload, len) && (type == cxrLogArg_Int || type == cxrLogArg_Uint))
+                memcpy(&value, payload, sizeof(value));
+            return (int)value;
+        }
+    };
+}
+
+//-----------------------------------------------------------------------------
+// Walks the format string, handing each conversion spec to snprintf on its own
+// with the matching captured arg, cast per its length modifier.
+//-----------------------------------------------------------------------------
+size_t cxrFormatLogRecord(const void* record, char* out, size_t outSize)
+{
+    if (outSize == 0)
+        return 0;
+
+    cxrLogRecordHeader header;
+    memcpy(&header, record, sizeof(header));
+
+    const uint8_t* base = (const uint8_t*)record;
+    ArgReader args = { base + sizeof(header), base + header.size, header.numArgs };
+
+    size_t used = 0;
+    const char* f = header.fmt ? header.fmt : "";
+    while (*f && used + 1 < outSize)
+    {
+        if (*f != '%')
+        {
+            out[used++] = *f++;
+            continue;
+        }
+
+        if (f[1] == '%')
+        {
+            out[used++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // collect the spec: flags, width, precision, length, conversion.
+        char spec[32];
+        size_t specLen = 0;
+        spec[specLen++] = *f++;
+        int star[2];
+        int numStars = 0;
+        while (*f && strchr("-+ #0123456789.*hljztL", *f) && specLen < sizeof(spec) - 2)
+        {
+            if (*f == '*' && numStars < 2)
+                star[numStars++] = args.NextInt();
+            spec[specLen++] = *f++;
+        }
+        if (!*f)
+            break;
+        const char conv = *f++;
+        spec[specLen++] = conv;
+        spec[specLen] = 0;
+
+        // length modifier decides the C type snprintf expects.
+        const bool isLongLong = strstr(spec, "ll") || strchr(spec, 'j') || strchr(spec, 'z') || strchr(spec, 't');
+        const bool isLong = !isLongLong && strchr(spec, 'l');
+
+        cxrLogArgType type;
+        const uint8_t* payload = nullptr;
+        uint16_t strLen = 0;
+        if (conv == 'n' || !args.Next(type, payload, strLen))
+            continue; // mismatched or unsupported, skip rather than read garbage.
+
+        char* dst = out + used;
+        const size_t room = outSize - used;
+        int written = 0;
+
+        int64_t i64 = 0;
+        double dbl = 0;
+        const void* ptr = nullptr;
+        if (type == cxrLogArg_Int || type == cxrLogArg_Uint)
+            memcpy(&i64, payload, sizeof(i64));
+        else if (type == cxrLogArg_Double)
+            memcpy(&dbl, payload, sizeof(dbl));
+        else if (type == cxrLogArg_Pointer)
+            memcpy(&ptr, payload, sizeof(ptr));
+
+#define CXR_SPEC_PRINT(value) \
+        (numStars == 2 ? snprintf(dst, room, spec, star[0], star[1], value) : \
+         numStars == 1 ? snprintf(dst, room, spec, star[0], value) : \
+                         snprintf(dst, room, spec, value))
+
+        switch (conv)
+        {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            if (type == cxrLogArg_Double)
+                i64 = (int64_t)dbl;
+            if (isLongLong)
+                written = CXR_SPEC_PRINT((long long)i64);
+            else if (isLong)
+                written = CXR_SPEC_PRINT((long)i64);
+            else
+                written = CXR_SPEC_PRINT((int)i64);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            if (type != cxrLogArg_Double)
+                dbl = (type == cxrLogArg_Uint) ? (double)(uint64_t)i64 : (double)i64;
+            written = strchr(spec, 'L') ? CXR_SPEC_PRINT((long double)dbl) : CXR_SPEC_PRINT(dbl);
+            break;
+        case 's':
+            if (type == cxrLogArg_String)
+            {
+                // strings are stored without a terminator, add one for snprintf.
+                char str[CXR_LOG_RECORD_MAX];
+                memcpy(str, payload, strLen);
+                str[strLen] = 0;
+                written = CXR_SPEC_PRINT((const char*)str);
+            }
+            else
+                written = snprintf(dst, room, "(?)");
+            break;
+        case 'p':
+            written = CXR_SPEC_PRINT(ptr);
+            break;
+        default:
+            written = snprintf(dst, room, "%s", spec); // unknown, echo it.
+            break;
+        }
+#undef CXR_SPEC_PRINT
+
+        if (written < 0)
+            break;
+        used += ((size_t)written < room) ? (size_t)written : room - 1;
+    }
+
+    if (header.truncated && used + 4 < outSize)
+    {
+        memcpy(out + used, " ...", 4);
+        used += 4;
+    }
+
+    out[used] = 0;
+    return used;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_LOG_DEFERRED_H
+#define CLOUDXR_LOG_DEFERRED_H
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <type_traits>
+
+#include "CloudXRCommon.h"
+
+// Deferred-format logging: instead of formatting at the call site, the macros
+// capture the format pointer and the raw argument values into a small binary
+// record, and the log writer thread formats it later.  The format string and
+// tag must outlive the record, which holds for the string literals the CXR_LOG
+// macros pass; string ARGUMENTS are copied into the record (truncated if long).
+
+#if defined(_WIN32)
+#define CXR_LOG_DEFERRED_SUPPORTED 0
+#else
+#define CXR_LOG_DEFERRED_SUPPORTED 1
+#endif
+
+static const uint32_t CXR_LOG_RECORD_MAX = 512;
+
+typedef enum
+{
+    cxrLogArg_Int = 0,      // stored as int64
+    cxrLogArg_Uint = 1,     // stored as uint64
+    cxrLogArg_Double = 2,
+    cxrLogArg_Pointer = 3,
+    cxrLogArg_String = 4,   // uint16 length + bytes, no terminator
+} cxrLogArgType;
+
+struct cxrLogRecordHeader
+{
+    uint16_t size;          // whole record, header included
+    uint8_t level;
+    uint8_t category;
+    uint8_t numArgs;
+    uint8_t truncated;
+    uint8_t pad[2];
+    int64_t timeNs;         // CLOCK_REALTIME, so it matches immediate lines' timestamps
+    const char* tag;
+    const char* fmt;
+};
+
+#if CXR_LOG_DEFERRED_SUPPORTED
+class cxrLogRecordWriter
+{
+public:
+    cxrLogRecordWriter(uint8_t* buf) : m_buf(buf), m_used(sizeof(cxrLogRecordHeader)) {}
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+    Add(T value)
+    {
+        if (std::is_signed<T>::value || std::is_enum<T>::value)
+            AddRaw(cxrLogArg_Int, (int64_t)value);
+        else
+            AddRaw(cxrLogArg_Uint, (uint64_t)value);
+    }
+    void Add(double value) { AddRaw(cxrLogArg_Double, value); }
+    void Add(float value) { AddRaw(cxrLogArg_Double, (double)value); }
+    void Add(const void* value) { AddRaw(cxrLogArg_Pointer, value); }
+    void Add(char* value) { Add((const char*)value); }
+    void Add(const char* value)
+    {
+        if (value == nullptr)
+            value = "(null)";
+        size_t len = strlen(value);
+        const size_t room = CXR_LOG_RECORD_MAX - m_used;
+        if (room < 1 + sizeof(uint16_t))
+        {
+            m_truncated = true;
+            return;
+        }
+        if (len > room - 1 - sizeof(uint16_t))
+        {
+            len = room - 1 - sizeof(uint16_t);
+            m_truncated = true;
+        }
+        const uint16_t len16 = (uint16_t)len;
+        m_buf[m_used++] = cxrLogArg_String;
+        memcpy(m_buf + m_used, &len16, sizeof(len16));
+        m_used += sizeof(len16);
+        memcpy(m_buf + m_used, value, len);
+        m_used += len;
+        m_numArgs++;
+    }
+
+    uint32_t Finish(cxrLogLevel ll, cxrMessageCategory mc, const char* tag, const char* fmt)
+    {
+        cxrLogRecordHeader header = {};
+        header.size = (uint16_t)m_used;
+        header.level = (uint8_t)ll;
+        header.category = (uint8_t)mc;
+        header.numArgs = m_numArgs;
+        header.truncated = m_truncated ? 1 : 0;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        header.timeNs = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+        header.tag = tag;
+        header.fmt = fmt;
+        memcpy(m_buf, &header, sizeof(header));
+        return (uint32_t)m_used;
+    }
+
+private:
+    template <typename T>
+    void AddRaw(cxrLogArgType type, T value)
+    {
+        if (m_used + 1 + sizeof(T) > CXR_LOG_RECORD_MAX)
+        {
+            m_truncated = true;
+            return;
+        }
+        m_buf[m_used++] = (uint8_t)type;
+        memcpy(m_buf + m_used, &value, sizeof(T));
+        m_used += sizeof(T);
+        m_numArgs++;
+    }
+
+    uint8_t* m_buf;
+    size_t m_used;
+    uint8_t m_numArgs = 0;
+    bool m_truncated = false;
+};
+
+// the including binary MUST implement this, alongside dispatchLogMsg, to route records.
+extern "C" void dispatchLogRecord(cxrLogLevel level, const void* record, uint32_t size);
+
+inline void cxrLogAddArgs(cxrLogRecordWriter&) {}
+
+template <typename T, typename... Rest>
+inline void cxrLogAddArgs(cxrLogRecordWriter& writer, T value, Rest... rest)
+{
+    writer.Add(value);
+    cxrLogAddArgs(writer, rest...);
+}
+
+template <typename... Args>
+inline void cxrLogDeferred(cxrLogLevel ll, cxrMessageCategory mc, const char* tag, const char* fmt, Args... args)
+{
+    alignas(8) uint8_t record[CXR_LOG_RECORD_MAX];
+    cxrLogRecordWriter writer(record);
+    cxrLogAddArgs(writer, args...);
+    const uint32_t size = writer.Finish(ll, mc, tag, fmt);
+    dispatchLogRecord(ll, record, size);
+}
+
+#endif // CXR_LOG_DEFERRED_SUPPORTED
+
+// formats the message part of a record (no timestamp/level/tag prefix) into out,
+// using the captured args in place of a va_list.  returns characters written.
+size_t cxrFormatLogRecord(const void* record, char* out, size_t outSize);
+
+#endif // CLOUDXR_LOG_DEFERRED_H
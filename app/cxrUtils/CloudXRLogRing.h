@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_LOG_RING_H
+#define CLOUDXR_LOG_RING_H
+
+#include <atomic>
+#include <memory>
+#include <string.h>
+#include <stdint.h>
+
+// Bounded lock-free multi-producer, single-consumer ring of preformatted log
+// text.  Text is cut into fixed size slots; a line claims all the slots it needs
+// in one CAS, so a line's chunks are always contiguous and the consumer can just
+// concatenate slots in order.  Producers never block: if the ring is full the
+// line is dropped and counted.
+class cxrLogRing
+{
+public:
+    static constexpr uint32_t SlotBytes = 256;
+
+    // numSlots must be a power of two.
+    explicit cxrLogRing(uint32_t numSlots)
+        : m_slots(new Slot[numSlots]), m_mask(numSlots - 1)
+    {
+        for (uint32_t i = 0; i < numSlots; ++i)
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    // urgent marks lines the consumer should flush promptly, i.e. errors.
+    // wakeConsumer, if given, is set each time producers pass another half ring
+    // of traffic, so a burst can get the consumer up before the ring fills.
+    bool Push(const char* text, size_t len, bool urgent, bool* wakeConsumer = nullptr)
+    {
+        const uint64_t count = (len + PayloadBytes - 1) / PayloadBytes;
+        if (count == 0)
+            return true;
+        if (count > m_mask + 1)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // claim [pos, pos+count).  the consumer frees slots in order, so if the
+        // last one we'd claim is free for this lap, the ones before it are too.
+        uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            const uint64_t last = pos + count - 1;
+            const uint64_t seq = m_slots[last & m_mask].seq.load(std::memory_order_acquire);
+            const int64_t diff = (int64_t)seq - (int64_t)last;
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false; // full
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            Slot& slot = m_slots[(pos + i) & m_mask];
+            const size_t chunk = (len > PayloadBytes) ? PayloadBytes : len;
+            memcpy(slot.text, text, chunk);
+            slot.len = (uint16_t)chunk;
+            slot.urgent = urgent ? 1 : 0;
+            slot.seq.store(pos + i + 1, std::memory_order_release);
+            text += chunk;
+            len -= chunk;
+        }
+        if (wakeConsumer)
+        {
+            const uint64_t half = (m_mask + 1) / 2;
+            *wakeConsumer = (pos / half) != ((pos + count) / half);
+        }
+        return true;
+    }
+
+    // consumer only.  copies published text in order into out, up to outCap
+    // bytes, stopping at the first slot not yet published.  returns bytes copied.
+    size_t Drain(char* out, size_t outCap, bool& urgent)
+    {
+        size_t used = 0;
+        for (;;)
+        {
+            Slot& slot = m_slots[m_dequeuePos & m_mask];
+            if (slot.seq.load(std::memory_order_acquire) != m_dequeuePos + 1)
+                break;
+            if (used + slot.len > outCap)
+                break;
+
+            memcpy(out + used, slot.text, slot.len);
+            used += slot.len;
+            urgent |= (slot.urgent != 0);
+
+            slot.seq.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+            m_dequeuePos++;
+        }
+        return used;
+    }
+
+    uint32_t TakeDropped() { return m_dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t PayloadBytes = SlotBytes - 16;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> seq;
+        uint16_t len;
+        uint8_t urgent;
+        char pad[5];
+        char text[PayloadBytes];
+    };
+    static_assert(sizeof(Slot) == SlotBytes, "log ring slot should be exactly SlotBytes");
+
+    std::unique_ptr<Slot[]> m_slots;
+    const uint64_t m_mask;
+    std::atomic<uint64_t> m_enqueuePos{0};
+    uint64_t m_dequeuePos = 0; // consumer only.
+    std::atomic<uint32_t> m_dropped{0};
+};
+
+#endif // CLOUDXR_LOG_RING_H
@@ -131,4 +131,259 @@ static inline void cxrTransformVector(const cxrMatrix34* inMat, const cxrVector3
     }
 }
 
+//-----------------------------------------------------------------------------
+// Quaternion pose math.  The scalar functions are the reference, the *4
+// variants work on up to four poses at once (HMD + both controllers) laid out
+// one component per array so each maps straight onto a NEON register.  On
+// targets without NEON the *4 variants fall back to the scalar reference.
+//-----------------------------------------------------------------------------
+
+static inline cxrQuaternion cxrQuatConjugate(const cxrQuaternion* q)
+{
+    cxrQuaternion out = { q->w, -q->x, -q->y, -q->z };
+    return out;
+}
+
+// a*b, applying b first then a, same as multiplying their rotation matrices.
+static inline cxrQuaternion cxrQuatMultiply(const cxrQuaternion* a, const cxrQuaternion* b)
+{
+    cxrQuaternion out;
+    out.w = a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z;
+    out.x = a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y;
+    out.y = a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x;
+    out.z = a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w;
+    return out;
+}
+
+// rotates v by unit quaternion q, without building a matrix.
+static inline void cxrQuatRotateVector(const cxrQuaternion* q, const cxrVector3* v, cxrVector3* out)
+{
+    // t = 2 * cross(q.xyz, v), v' = v + w*t + cross(q.xyz, t)
+    const float tx = 2.0f * (q->y * v->v[2] - q->z * v->v[1]);
+    const float ty = 2.0f * (q->z * v->v[0] - q->x * v->v[2]);
+    const float tz = 2.0f * (q->x * v->v[1] - q->y * v->v[0]);
+    out->v[0] = v->v[0] + q->w * tx + (q->y * tz - q->z * ty);
+    out->v[1] = v->v[1] + q->w * ty + (q->z * tx - q->x * tz);
+    out->v[2] = v->v[2] + q->w * tz + (q->x * ty - q->y * tx);
+}
+
+// q and -q are the same rotation, cxrMatrixToVecQuat always returns w >= 0, so match it.
+static inline void cxrQuatCanonicalize(cxrQuaternion* q)
+{
+    if (q->w < 0.0f)
+    {
+        q->w = -q->w; q->x = -q->x; q->y = -q->y; q->z = -q->z;
+    }
+}
+
+#define CXR_POSE_BATCH_MAX 4
+
+typedef struct
+{
+    float w[CXR_POSE_BATCH_MAX];
+    float x[CXR_POSE_BATCH_MAX];
+    float y[CXR_POSE_BATCH_MAX];
+    float z[CXR_POSE_BATCH_MAX];
+} cxrQuaternion4;
+
+typedef struct
+{
+    float x[CXR_POSE_BATCH_MAX];
+    float y[CXR_POSE_BATCH_MAX];
+    float z[CXR_POSE_BATCH_MAX];
+} cxrVector3x4;
+
+static inline void cxrQuat4Set(cxrQuaternion4* q4, int lane, const cxrQuaternion* q)
+{
+    q4->w[lane] = q->w; q4->x[lane] = q->x; q4->y[lane] = q->y; q4->z[lane] = q->z;
+}
+
+static inline cxrQuaternion cxrQuat4Get(const cxrQuaternion4* q4, int lane)
+{
+    cxrQuaternion q = { q4->w[lane], q4->x[lane], q4->y[lane], q4->z[lane] };
+    return q;
+}
+
+static inline void cxrQuat4SetIdentity(cxrQuaternion4* q4)
+{
+    for (int i = 0; i < CXR_POSE_BATCH_MAX; ++i)
+    {
+        q4->w[i] = 1.0f; q4->x[i] = 0.0f; q4->y[i] = 0.0f; q4->z[i] = 0.0f;
+    }
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+
+static inline void cxrQuatMultiply4(const cxrQuaternion4* a, const cxrQuaternion4* b, cxrQuaternion4* out)
+{
+    const float32x4_t aw = vld1q_f32(a->w), ax = vld1q_f32(a->x), ay = vld1q_f32(a->y), az = vld1q_f32(a->z);
+    const float32x4_t bw = vld1q_f32(b->w), bx = vld1q_f32(b->x), by = vld1q_f32(b->y), bz = vld1q_f32(b->z);
+
+    float32x4_t w = vmulq_f32(aw, bw);
+    w = vfmsq_f32(w, ax, bx); w = vfmsq_f32(w, ay, by); w = vfmsq_f32(w, az, bz);
+    float32x4_t x = vmulq_f32(aw, bx);
+    x = vfmaq_f32(x, ax, bw); x = vfmaq_f32(x, ay, bz); x = vfmsq_f32(x, az, by);
+    float32x4_t y = vmulq_f32(aw, by);
+    y = vfmsq_f32(y, ax, bz); y = vfmaq_f32(y, ay, bw); y = vfmaq_f32(y, az, bx);
+    float32x4_t z = vmulq_f32(aw, bz);
+    z = vfmaq_f32(z, ax, by); z = vfmsq_f32(z, ay, bx); z = vfmaq_f32(z, az, bw);
+
+    vst1q_f32(out->w, w); vst1q_f32(out->x, x); vst1q_f32(out->y, y); vst1q_f32(out->z, z);
+}
+
+// inverse rotates by the conjugate, e.g. world space -> device space.
+static inline void cxrQuatRotate4(const cxrQuaternion4* q, const cxrVector3x4* v, cxrVector3x4* out, bool inverse)
+{
+    const float32x4_t qw = vld1q_f32(q->w);
+    float32x4_t qx = vld1q_f32(q->x), qy = vld1q_f32(q->y), qz = vld1q_f32(q->z);
+    if (inverse)
+    {
+        qx = vnegq_f32(qx); qy = vnegq_f32(qy); qz = vnegq_f32(qz);
+    }
+    const float32x4_t vx = vld1q_f32(v->x), vy = vld1q_f32(v->y), vz = vld1q_f32(v->z);
+
+    const float32x4_t tx = vmulq_n_f32(vfmsq_f32(vmulq_f32(qy, vz), qz, vy), 2.0f);
+    const float32x4_t ty = vmulq_n_f32(vfmsq_f32(vmulq_f32(qz, vx), qx, vz), 2.0f);
+    const float32x4_t tz = vmulq_n_f32(vfmsq_f32(vmulq_f32(qx, vy), qy, vx), 2.0f);
+
+    vst1q_f32(out->x, vaddq_f32(vfmaq_f32(vx, qw, tx), vfmsq_f32(vmulq_f32(qy, tz), qz, ty)));
+    vst1q_f32(out->y, vaddq_f32(vfmaq_f32(vy, qw, ty), vfmsq_f32(vmulq_f32(qz, tx), qx, tz)));
+    vst1q_f32(out->z, vaddq_f32(vfmaq_f32(vz, qw, tz), vfmsq_f32(vmulq_f32(qx, ty), qy, tx)));
+}
+
+static inline void cxrQuatCanonicalize4(cxrQuaternion4* q)
+{
+    const float32x4_t w = vld1q_f32(q->w);
+    const uint32x4_t negative = vcltq_f32(w, vdupq_n_f32(0.0f));
+    const float32x4_t sign = vbslq_f32(negative, vdupq_n_f32(-1.0f), vdupq_n_f32(1.0f));
+    vst1q_f32(q->w, vmulq_f32(w, sign));
+    vst1q_f32(q->x, vmulq_f32(vld1q_f32(q->x), sign));
+    vst1q_f32(q->y, vmulq_f32(vld1q_f32(q->y), sign));
+    vst1q_f32(q->z, vmulq_f32(vld1q_f32(q->z), sign));
+}
+
+#else // scalar reference path
+
+static inline void cxrQuatMultiply4(const cxrQuaternion4* a, const cxrQuaternion4* b, cxrQuaternion4* out)
+{
+    for (int i = 0; i < CXR_POSE_BATCH_MAX; ++i)
+    {
+        const cxrQuaternion qa = cxrQuat4Get(a, i);
+        const cxrQuaternion qb = cxrQuat4Get(b, i);
+        const cxrQuaternion r = cxrQuatMultiply(&qa, &qb);
+        cxrQuat4Set(out, i, &r);
+    }
+}
+
+static inline void cxrQuatRotate4(const cxrQuaternion4* q, const cxrVector3x4* v, cxrVector3x4* out, bool inverse)
+{
+    for (int i = 0; i < CXR_POSE_BATCH_MAX; ++i)
+    {
+        cxrQuaternion qi = cxrQuat4Get(q, i);
+        if (inverse)
+            qi = cxrQuatConjugate(&qi);
+        const cxrVector3 vi = {{ v->x[i], v->y[i], v->z[i] }};
+        cxrVector3 r;
+        cxrQuatRotateVector(&qi, &vi, &r);
+        out->x[i] = r.v[0]; out->y[i] = r.v[1]; out->z[i] = r.v[2];
+    }
+}
+
+static inline void cxrQuatCanonicalize4(cxrQuaternion4* q)
+{
+    for (int i = 0; i < CXR_POSE_BATCH_MAX; ++i)
+    {
+        cxrQuaternion qi = cxrQuat4Get(q, i);
+        cxrQuatCanonicalize(&qi);
+        cxrQuat4Set(q, i, &qi);
+    }
+}
+
+#endif // __ARM_NEON
+
+// Checks the batched quaternion path against the scalar helpers over a fixed
+// pseudo-random set of rotations and vectors, returning the largest component
+// error seen.  CloudXRBenchmark --check fails above its tolerance.
+static inline float cxrPoseMathValidate(uint32_t iterations)
+{
+    uint32_t seed = 12345;
+    #define CXR_VALIDATE_RAND() ((seed = seed * 1664525u + 1013904223u), ((seed >> 8) * (2.0f / 16777216.0f) - 1.0f))
+
+    float maxError = 0.0f;
+    for (uint32_t iter = 0; iter < iterations; ++iter)
+    {
+        cxrQuaternion4 a, b, prod;
+        cxrVector3x4 v, rotated, unrotated;
+        for (int i = 0; i < CXR_POSE_BATCH_MAX; ++i)
+        {
+            cxrQuaternion qa = { CXR_VALIDATE_RAND(), CXR_VALIDATE_RAND(), CXR_VALIDATE_RAND(), CXR_VALIDATE_RAND() };
+            cxrQuaternion qb = { CXR_VALIDATE_RAND(), CXR_VALIDATE_RAND(), CXR_VALIDATE_RAND(), CXR_VALIDATE_RAND() };
+            const float la = sqrtf(qa.w * qa.w + qa.x * qa.x + qa.y * qa.y + qa.z * qa.z) + 1e-6f;
+            const float lb = sqrtf(qb.w * qb.w + qb.x * qb.x + qb.y * qb.y + qb.z * qb.z) + 1e-6f;
+            qa.w /= la; qa.x /= la; qa.y /= la; qa.z /= la;
+            qb.w /= lb; qb.x /= lb; qb.y /= lb; qb.z /= lb;
+            cxrQuat4Set(&a, i, &qa);
+            cxrQuat4Set(&b, i, &qb);
+            v.x[i] = CXR_VALIDATE_RAND(); v.y[i] = CXR_VALIDATE_RAND(); v.z[i] = CXR_VALIDATE_RAND();
+        }
+
+        cxrQuatMultiply4(&a, &b, &prod);
+        cxrQuatCanonicalize4(&prod);
+        cxrQuatRotate4(&a, &v, &rotated, false);
+        cxrQuatRotate4(&a, &v, &unrotated, true);
+
+        for (int i = 0; i < CXR_POSE_BATCH_MAX; ++i)
+        {
+            const cxrQuaternion qa = cxrQuat4Get(&a, i);
+            const cxrQuaternion qb = cxrQuat4Get(&b, i);
+            const cxrVector3 vi = {{ v.x[i], v.y[i], v.z[i] }};
+
+            // product, component by component against the scalar multiply.  both are
+            // canonical, but with w ~0 rounding can leave them on opposite signs.
+            cxrQuaternion ref = cxrQuatMultiply(&qa, &qb);
+            cxrQuatCanonicalize(&ref);
+            const cxrQuaternion got = cxrQuat4Get(&prod, i);
+            const float sign = (ref.w * got.w + ref.x * got.x + ref.y * got.y + ref.z * got.z < 0.0f) ? -1.0f : 1.0f;
+            maxError = fmaxf(maxError, fabsf(ref.w - sign * got.w));
+            maxError = fmaxf(maxError, fabsf(ref.x - sign * got.x));
+            maxError = fmaxf(maxError, fabsf(ref.y - sign * got.y));
+            maxError = fmaxf(maxError, fabsf(ref.z - sign * got.z));
+
+            // the product's convention, through what it does to a vector: it has to agree
+            // with multiplying the rotation matrices.  converting the product matrix back
+            // to a quaternion would lose too much accuracy near w ~0 to compare tightly.
+            cxrMatrix34 ma, mb, mab;
+            cxrVecQuatToMatrix(NULL, &qa, &ma);
+            cxrVecQuatToMatrix(NULL, &qb, &mb);
+            cxrMatrixSetIdentity(&mab);
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    mab.m[r][c] = ma.m[r][0] * mb.m[0][c] + ma.m[r][1] * mb.m[1][c] + ma.m[r][2] * mb.m[2][c];
+            cxrVector3 refV, gotV;
+            cxrTransformVector(&mab, &vi, &refV);
+            cxrQuatRotateVector(&got, &vi, &gotV);
+            for (int c = 0; c < 3; ++c)
+                maxError = fmaxf(maxError, fabsf(refV.v[c] - gotV.v[c]));
+
+            // forward rotation against the rotation matrix.
+            cxrTransformVector(&ma, &vi, &refV);
+            maxError = fmaxf(maxError, fabsf(refV.v[0] - rotated.x[i]));
+            maxError = fmaxf(maxError, fabsf(refV.v[1] - rotated.y[i]));
+            maxError = fmaxf(maxError, fabsf(refV.v[2] - rotated.z[i]));
+
+            // inverse rotation against the full inverse and transform, as CloudXRController used to.
+            cxrMatrix34 inv;
+            cxrInverseMatrix(&ma, &inv);
+            cxrTransformVector(&inv, &vi, &refV);
+            maxError = fmaxf(maxError, fabsf(refV.v[0] - unrotated.x[i]));
+            maxError = fmaxf(maxError, fabsf(refV.v[1] - unrotated.y[i]));
+            maxError = fmaxf(maxError, fabsf(refV.v[2] - unrotated.z[i]));
+        }
+    }
+
+    #undef CXR_VALIDATE_RAND
+    return maxError;
+}
+
 #endif //ifndef CLOUDXR_MATRIX_HELPERS_H
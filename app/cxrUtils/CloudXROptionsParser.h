@@ -217,6 +217,29 @@ public:
         return ParseStatus_Success;
     }
 
+    // for callers that apply options one at a time and need each one's result,
+    // like the runtime control channel.  names are given without the leading '-'.
+    bool FindOption(std::string name, bool &valueRequired) const
+    {
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c){ return ::tolower(c); } );
+        const auto it = args.find(name);
+        if (it == args.end())
+            return false;
+        valueRequired = it->second.valueRequired;
+        return true;
+    }
+
+    ParseStatus HandleOption(std::string name, const std::string &value)
+    {
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c){ return ::tolower(c); } );
+        const auto it = args.find(name);
+        if (it == args.end())
+            return ParseStatus_Fail;
+        return it->second.handler(value);
+    }
+
 protected:
     bool GetNextToken(std::string &token)
     {
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_QUALITY_GOVERNOR_H
+#define CLOUDXR_QUALITY_GOVERNOR_H
+
+#include <stdint.h>
+
+#include "CloudXRClient.h"
+
+// Turns the connection quality stream into stepped quality levels, one per
+// problem the stats can name.  Latency trouble raises the latency level, which
+// the app spends on a lower refresh rate and heavier foveation.  Bandwidth or
+// loss trouble raises the bandwidth level, spent on resolution and bitrate.
+// Level 0 is the launch configuration.
+//
+// Changes go one step at a time with hysteresis: a problem has to persist for
+// DegradeHoldS to step down, the link has to stay good for the upgrade hold to
+// step back up, and an axis waits ChangeCooldownS after any change.  Stepping
+// up and getting knocked back down soon after doubles that axis' upgrade hold,
+// so a link sitting right on the edge doesn't flap.
+class cxrQualityGovernor
+{
+public:
+    static constexpr uint32_t MaxLevel = 3;
+    static constexpr double DegradeHoldS = 3.0;
+    static constexpr double UpgradeHoldS = 15.0;
+    static constexpr double MaxUpgradeHoldS = 120.0;
+    static constexpr double ChangeCooldownS = 5.0;
+    static constexpr double FlapWindowS = 30.0;
+
+    enum Axis
+    {
+        Axis_Latency = 0,
+        Axis_Bandwidth,
+        Axis_Count
+    };
+
+    void Reset()
+    {
+        for (AxisState& a : m_axes)
+            a = AxisState();
+    }
+
+    // feed every stats sample.  returns true if a level changed.
+    bool Update(const cxrConnectionStats& stats, double nowS)
+    {
+        // reasons only mean something on a degraded link, where none at all says
+        // it's still estimating.  nothing to judge then, and a stale good/bad run
+        // shouldn't carry across it.
+        const bool poor = (stats.quality <= cxrConnectionQuality_Fair);
+        const bool good = (stats.quality >= cxrConnectionQuality_Good);
+        const bool estimating = poor && (stats.qualityReasons == cxrConnectionQualityReason_EstimatingQuality);
+
+        bool bad[Axis_Count];
+        bad[Axis_Latency] = poor && !estimating && (stats.qualityReasons & cxrConnectionQualityReason_HighLatency);
+        bad[Axis_Bandwidth] = poor && !estimating &&
+                (stats.qualityReasons & (cxrConnectionQualityReason_LowBandwidth | cxrConnectionQualityReason_HighPacketLoss));
+
+        bool changed = false;
+        for (uint32_t i = 0; i < Axis_Count; ++i)
+        {
+            AxisState& a = m_axes[i];
+            if (estimating)
+            {
+                a.badSinceS = a.goodSinceS = 0;
+                continue;
+            }
+
+            a.badSinceS = bad[i] ? (a.badSinceS ? a.badSinceS : nowS) : 0;
+            a.goodSinceS = (good && !bad[i]) ? (a.goodSinceS ? a.goodSinceS : nowS) : 0;
+
+            if (a.lastChangeS && nowS - a.lastChangeS < ChangeCooldownS)
+                continue;
+
+            if (a.badSinceS && nowS - a.badSinceS >= DegradeHoldS && a.level < MaxLevel)
+            {
+                // knocked back soon after an upgrade, be slower to try again.
+                if (a.lastUpgradeS && nowS - a.lastUpgradeS < FlapWindowS)
+                    a.upgradeHoldS = (a.upgradeHoldS * 2 < MaxUpgradeHoldS) ? a.upgradeHoldS * 2 : MaxUpgradeHoldS;
+                a.level++;
+                a.lastChangeS = nowS;
+                a.badSinceS = 0;
+                changed = true;
+            }
+            else if (a.goodSinceS && nowS - a.goodSinceS >= a.upgradeHoldS && a.level > 0)
+            {
+                a.level--;
+                a.lastChangeS = a.lastUpgradeS = nowS;
+                a.goodSinceS = 0;
+                changed = true;
+            }
+            else if (a.lastUpgradeS && nowS - a.lastUpgradeS > MaxUpgradeHoldS)
+            {
+                // stable for a good while, forget past flapping.
+                a.upgradeHoldS = UpgradeHoldS;
+            }
+        }
+        return changed;
+    }
+
+    uint32_t Level(Axis axis) const { return m_axes[axis].level; }
+
+    //-------------------------------------------------------------------------
+    // what a level means for each knob, relative to the launch setting.
+    //-------------------------------------------------------------------------
+    static float ResFactorScale(uint32_t bandwidthLevel)
+    {
+        static const float scale[MaxLevel + 1] = { 1.0f, 0.85f, 0.7f, 0.6f };
+        return scale[bandwidthLevel < MaxLevel ? bandwidthLevel : MaxLevel];
+    }
+
+    static float BitrateScale(uint32_t bandwidthLevel)
+    {
+        static const float scale[MaxLevel + 1] = { 1.0f, 0.75f, 0.55f, 0.4f };
+        return scale[bandwidthLevel < MaxLevel ? bandwidthLevel : MaxLevel];
+    }
+
+    // foveation is a percentage scale where lower is more aggressive and 0 is off.
+    static uint32_t Foveation(uint32_t launchFoveation, uint32_t latencyLevel)
+    {
+        static const uint32_t steps[MaxLevel + 1] = { 0, 75, 60, 50 };
+        const uint32_t step = steps[latencyLevel < MaxLevel ? latencyLevel : MaxLevel];
+        if (step == 0)
+            return launchFoveation;
+        return (launchFoveation == 0 || step < launchFoveation) ? step : launchFoveation;
+    }
+
+private:
+    struct AxisState
+    {
+        uint32_t level = 0;
+        double badSinceS = 0;
+        double goodSinceS = 0;
+        double lastChangeS = 0;
+        double lastUpgradeS = 0;
+        double upgradeHoldS = UpgradeHoldS;
+    };
+
+    AxisState m_axes[Axis_Count];
+};
+
+#endif // CLOUDXR_QUALITY_GOVERNOR_H
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_SEQLOCK_H
+#define CLOUDXR_SEQLOCK_H
+
+#include <atomic>
+#include <string.h>
+#include <stdint.h>
+#include <type_traits>
+
+// Single-writer, multi-reader sequence lock for small POD snapshots.
+// The writer never blocks, readers never take a lock: a reader copies the
+// payload and retries only if the writer published in the middle of the copy.
+// Intended for high-rate state like tracking samples, where the consumer only
+// ever wants the latest value and can't afford to wait on the producer.
+template <typename T>
+class cxrSeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "cxrSeqLock payload must be trivially copyable");
+
+public:
+    cxrSeqLock() { memset(&m_value, 0, sizeof(T)); }
+
+    // only ONE thread may call Store.
+    void Store(const T& value)
+    {
+        const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed); // odd == write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&m_value, &value, sizeof(T));
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // returns the sequence number of the copied value, 0 if nothing yet published.
+    uint32_t Load(T& out) const
+    {
+        uint32_t before, after;
+        do
+        {
+            before = m_seq.load(std::memory_order_acquire);
+            if (before & 1)
+                continue; // writer mid-copy, spin until it finishes.
+            memcpy(&out, &m_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        return before >> 1;
+    }
+
+    // cheap check used to tell if anything new was published since a prior Load.
+    uint32_t Sequence() const { return m_seq.load(std::memory_order_acquire) >> 1; }
+
+private:
+    std::atomic<uint32_t> m_seq{0};
+    T m_value;
+};
+
+#endif // CLOUDXR_SEQLOCK_H
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "CXRProbe"
+#include "CloudXRLog.h"
+
+#include "CloudXRServerProbe.h"
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+float cxrServerProbe::Result::Score() const
+{
+    if (!Reachable())
+        return INFINITY;
+    const float lossPenaltyMs = (float)ProbeTimeoutMs * failed / sent;
+    return rttMs + 2.0f * jitterMs + lossPenaltyMs;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool cxrServerProbe::Start(const std::vector<std::string>& servers, uint32_t probesPerServer, uint16_t port)
+{
+    if (IsRunning() || servers.empty() || probesPerServer == 0)
+        return false;
+
+    m_probes = probesPerServer;
+    m_port = port;
+    m_cancel = false;
+    m_results.assign(servers.size(), Result());
+    for (size_t i = 0; i < servers.size(); ++i)
+        m_results[i].address = servers[i];
+
+    m_remaining = (uint32_t)servers.size();
+    for (uint32_t i = 0; i < servers.size(); ++i)
+        m_threads.emplace_back([this, i]() { ProbeLoop(i); });
+
+    CXR_LOGI("Probing %zu candidate servers, %u probes each.", servers.size(), probesPerServer);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrServerProbe::Stop()
+{
+    if (!IsDone())
+        m_cancel = true;
+    for (auto& t : m_threads)
+        if (t.joinable())
+            t.join();
+    m_threads.clear();
+}
+
+//-----------------------------------------------------------------------------
+// A non-blocking connect, timed from the SYN to the socket turning writable.
+// Name lookup happens before the clock starts, so only the network is timed.
+//-----------------------------------------------------------------------------
+float cxrServerProbe::ConnectOnce(const std::string& address, uint16_t port)
+{
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* info = nullptr;
+    const std::string service = std::to_string(port);
+    if (getaddrinfo(address.c_str(), service.c_str(), &hints, &info) != 0 || !info)
+        return -1;
+
+    float rttMs = -1;
+    const int fd = socket(info->ai_family, info->ai_socktype | SOCK_NONBLOCK, info->ai_protocol);
+    if (fd >= 0)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        int r = connect(fd, info->ai_addr, info->ai_addrlen);
+        if (r < 0 && errno == EINPROGRESS)
+        {
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            r = (poll(&pfd, 1, ProbeTimeoutMs) == 1) ? 0 : -1;
+            if (r == 0)
+            {
+                int soErr = 0;
+                socklen_t len = sizeof(soErr);
+                if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &soErr, &len) != 0 || soErr != 0)
+                    r = -1; // refused means nothing is listening, which is as good as down.
+            }
+        }
+        if (r == 0)
+            rttMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        close(fd);
+    }
+
+    freeaddrinfo(info);
+    return rttMs;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrServerProbe::ProbeLoop(uint32_t index)
+{
+    Result& result = m_results[index];
+    std::vector<float> rtts;
+    rtts.reserve(m_probes);
+
+    float diffSum = 0;
+    for (uint32_t i = 0; i < m_probes && !m_cancel; ++i)
+    {
+        if (i > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(ProbeIntervalMs));
+
+        const float rtt = ConnectOnce(result.address, m_port);
+        result.sent++;
+        if (rtt < 0)
+        {
+            result.failed++;
+            continue;
+        }
+        if (!rtts.empty())
+            diffSum += fabsf(rtt - rtts.back());
+        rtts.push_back(rtt);
+    }
+
+    if (!rtts.empty())
+    {
+        if (rtts.size() > 1)
+            result.jitterMs = diffSum / (rtts.size() - 1);
+        std::sort(rtts.begin(), rtts.end());
+        result.minRttMs = rtts.front();
+        result.rttMs = rtts[rtts.size() / 2];
+    }
+
+    m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+std::vector<cxrServerProbe::Result> cxrServerProbe::Ranked() const
+{
+    if (!IsDone())
+        return {};
+    std::vector<Result> ranked = m_results;
+    // stable, so unreachable servers keep the order they were given in.
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const Result& a, const Result& b) { return a.Score() < b.Score(); });
+    return ranked;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_SERVER_PROBE_H
+#define CLOUDXR_SERVER_PROBE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+// Measures round trip to a set of candidate servers, all at once, so the client
+// can pick the closest before it connects.  Each candidate gets its own thread
+// that times a series of TCP connects to the server's session port: the
+// handshake is one round trip, and needs nothing from the server beyond it
+// listening.  Connections are closed as soon as they're made.
+class cxrServerProbe
+{
+public:
+    static constexpr uint16_t DefaultPort = 48010;  // CloudXR session setup (RTSP).
+    static constexpr uint32_t ProbeIntervalMs = 50;
+    static constexpr uint32_t ProbeTimeoutMs = 500;
+
+    struct Result
+    {
+        std::string address;
+        uint32_t sent = 0;
+        uint32_t failed = 0;
+        float rttMs = 0;        // median of the successful probes.
+        float jitterMs = 0;     // mean difference between consecutive successful probes.
+        float minRttMs = 0;
+
+        bool Reachable() const { return failed < sent; }
+        // lower is better.  jitter counts double as it eats into the latency budget
+        // every frame, and each lost probe is charged like a timeout's worth of rtt.
+        float Score() const;
+    };
+
+    ~cxrServerProbe() { Stop(); }
+
+    bool Start(const std::vector<std::string>& servers, uint32_t probesPerServer, uint16_t port = DefaultPort);
+    bool IsRunning() const { return !m_threads.empty(); }
+    bool IsDone() const { return m_remaining.load(std::memory_order_acquire) == 0; }
+    // joins the probe threads, blocking until they finish if not yet done.
+    void Stop();
+
+    // once done: reachable servers best first, then the unreachable ones in given order.
+    std::vector<Result> Ranked() const;
+
+private:
+    void ProbeLoop(uint32_t index);
+    static float ConnectOnce(const std::string& address, uint16_t port); // ms, < 0 on failure.
+
+    std::vector<Result> m_results;
+    std::vector<std::thread> m_threads;
+    std::atomic<uint32_t> m_remaining{0};
+    std::atomic<bool> m_cancel{false};
+    uint32_t m_probes = 0;
+    uint16_t m_port = DefaultPort;
+};
+
+#endif // CLOUDXR_SERVER_PROBE_H
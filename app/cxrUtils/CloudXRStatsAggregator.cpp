@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#define LOG_TAG "CXRStats"
+#include "CloudXRLog.h"
+
+#include "CloudXRStatsAggregator.h"
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+cxrStatsHistogram::cxrStatsHistogram(float minValue, float bucketWidth, uint32_t numBuckets)
+    : m_minValue(minValue), m_bucketWidth(bucketWidth), m_buckets(numBuckets, 0)
+{
+}
+
+void cxrStatsHistogram::Add(float value)
+{
+    int32_t bucket = (int32_t)((value - m_minValue) / m_bucketWidth);
+    if (bucket < 0)
+        bucket = 0;
+    else if (bucket >= (int32_t)m_buckets.size())
+        bucket = (int32_t)m_buckets.size() - 1;
+    m_buckets[bucket]++;
+
+    if (m_count == 0 || value < m_min)
+        m_min = value;
+    if (m_count == 0 || value > m_max)
+        m_max = value;
+    m_sum += value;
+    m_count++;
+}
+
+void cxrStatsHistogram::Merge(const cxrStatsHistogram& other)
+{
+    if (other.m_count == 0)
+        return;
+
+    for (size_t i = 0; i < m_buckets.size() && i < other.m_buckets.size(); ++i)
+        m_buckets[i] += other.m_buckets[i];
+
+    if (m_count == 0 || other.m_min < m_min)
+        m_min = other.m_min;
+    if (m_count == 0 || other.m_max > m_max)
+        m_max = other.m_max;
+    m_sum += other.m_sum;
+    m_count += other.m_count;
+}
+
+void cxrStatsHistogram::Reset()
+{
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = m_max = 0;
+}
+
+float cxrStatsHistogram::Percentile(float pct) const
+{
+    if (m_count == 0)
+        return 0.0f;
+
+    uint32_t target = (uint32_t)ceil(pct / 100.0f * m_count);
+    if (target < 1)
+        target = 1;
+
+    uint32_t seen = 0;
+    for (size_t i = 0; i < m_buckets.size(); ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+        {
+            // bucket edges can fall outside what we actually saw, so clamp to it.
+            const float value = m_minValue + m_bucketWidth * i;
+            return (value < m_min) ? m_min : ((value > m_max) ? m_max : value);
+        }
+    }
+    return m_max;
+}
+
+//-----------------------------------------------------------------------------
+// Bucket layouts: 1ms rtt up to 1s, half-frame fps up to 240, 250kbps up to
+// 200mbps, 0.1% loss.  Anything past the end lands in the last bucket.
+//-----------------------------------------------------------------------------
+cxrStatsAggregator::Series::Series()
+    : rttMs(0.0f, 1.0f, 1000)
+    , fps(0.0f, 0.5f, 480)
+    , bitrateKbps(0.0f, 250.0f, 800)
+    , lossPct(0.0f, 0.1f, 1000)
+{
+}
+
+void cxrStatsAggregator::Series::Reset()
+{
+    rttMs.Reset();
+    fps.Reset();
+    bitrateKbps.Reset();
+    lossPct.Reset();
+}
+
+void cxrStatsAggregator::Series::Merge(const Series& other)
+{
+    rttMs.Merge(other.rttMs);
+    fps.Merge(other.fps);
+    bitrateKbps.Merge(other.bitrateKbps);
+    lossPct.Merge(other.lossPct);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool cxrStatsAggregator::Start(cxrReceiverHandle receiver, const std::string& outputFile, uint32_t summaryIntervalSec)
+{
+    if (m_thread.joinable() || receiver == nullptr)
+        return false;
+
+    m_file = fopen(outputFile.c_str(), "a");
+    if (!m_file)
+    {
+        CXR_LOGE("Err #%s opening stats file: %s", strerror(errno), outputFile.c_str());
+        return false;
+    }
+
+    m_receiver = receiver;
+    m_summaryIntervalSec = summaryIntervalSec;
+    m_startTime = std::chrono::steady_clock::now();
+    m_intervalStartS = 0;
+    m_interval.Reset();
+    m_session.Reset();
+    m_havePacketBaseline = false;
+
+    m_running = true;
+    m_thread = std::thread([this]() { SamplerLoop(); });
+
+    CXR_LOGI("Stats aggregator writing %ds summaries to %s", summaryIntervalSec, outputFile.c_str());
+    return true;
+}
+
+void cxrStatsAggregator::Stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+
+    const double nowS = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    if (m_interval.rttMs.Count() > 0)
+        WriteSummary("interval", m_interval, nowS - m_intervalStartS);
+    m_session.Merge(m_interval);
+    WriteSummary("session", m_session, nowS);
+
+    CXR_LOGI("Session stats: %d samples, RTT p50/p95/p99 (ms): %.0f / %.0f / %.0f, FPS p50/p1: %.1f / %.1f, loss p99 (%%): %.1f",
+             m_session.rttMs.Count(),
+             m_session.rttMs.Percentile(50), m_session.rttMs.Percentile(95), m_session.rttMs.Percentile(99),
+             m_session.fps.Percentile(50), m_session.fps.Percentile(1),
+             m_session.lossPct.Percentile(99));
+
+    fclose(m_file);
+    m_file = nullptr;
+    m_receiver = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrStatsAggregator::SamplerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running)
+    {
+        m_wake.wait_for(lock, std::chrono::milliseconds((int64_t)SampleIntervalMs), [this]() { return !m_running; });
+        if (!m_running)
+            break;
+
+        Sample();
+
+        const double nowS = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+        if (m_summaryIntervalSec > 0 && nowS - m_intervalStartS >= m_summaryIntervalSec)
+        {
+            WriteSummary("interval", m_interval, nowS - m_intervalStartS);
+            m_session.Merge(m_interval);
+            m_interval.Reset();
+            m_intervalStartS = nowS;
+        }
+    }
+}
+
+void cxrStatsAggregator::Sample()
+{
+    cxrConnectionStats stats = {};
+    if (cxrGetConnectionStats(m_receiver, &stats) != cxrError_Success)
+        return;
+
+    m_interval.rttMs.Add((float)stats.roundTripDelayMs);
+    m_interval.fps.Add(stats.framesPerSecond);
+    m_interval.bitrateKbps.Add((float)stats.bandwidthUtilizationKbps);
+
+    if (m_havePacketBaseline)
+    {
+        const uint32_t received = stats.totalPacketsReceived - m_lastPacketsReceived;
+        const uint32_t lost = stats.totalPacketsLost - m_lastPacketsLost;
+        if (received + lost > 0)
+            m_interval.lossPct.Add(100.0f * lost / (received + lost));
+    }
+    m_lastPacketsReceived = stats.totalPacketsReceived;
+    m_lastPacketsLost = stats.totalPacketsLost;
+    m_havePacketBaseline = true;
+}
+
+//-----------------------------------------------------------------------------
+// One compact json object per line, so the file can be streamed and appended.
+//-----------------------------------------------------------------------------
+void cxrStatsAggregator::WriteSummary(const char* kind, const Series& series, double durationS)
+{
+    if (!m_file)
+        return;
+
+    const double nowS = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    fprintf(m_file, "{\"type\":\"%s\",\"t\":%.1f,\"duration\":%.1f,\"samples\":%u", kind, nowS, durationS, series.rttMs.Count());
+
+    const struct { const char* name; const cxrStatsHistogram& hist; } entries[] = {
+        { "rtt_ms", series.rttMs },
+        { "fps", series.fps },
+        { "bitrate_kbps", series.bitrateKbps },
+        { "loss_pct", series.lossPct },
+    };
+    for (const auto& e : entries)
+    {
+        fprintf(m_file, ",\"%s\":{\"min\":%.1f,\"mean\":%.1f,\"p50\":%.1f,\"p95\":%.1f,\"p99\":%.1f,\"max\":%.1f}",
+                e.name, e.hist.Min(), e.hist.Mean(),
+                e.hist.Percentile(50), e.hist.Percentile(95), e.hist.Percentile(99), e.hist.Max());
+    }
+
+    fprintf(m_file, "}\n");
+    fflush(m_file);
+}
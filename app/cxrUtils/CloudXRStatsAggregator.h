@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_STATS_AGGREGATOR_H
+#define CLOUDXR_STATS_AGGREGATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "CloudXRClient.h"
+
+// Fixed-bucket histogram, all storage allocated up front so Add is O(1) and
+// never allocates.  Values above the last bucket are counted in it, min/max/mean
+// are exact.  Percentiles resolve to a bucket's lower edge.
+class cxrStatsHistogram
+{
+public:
+    cxrStatsHistogram(float minValue, float bucketWidth, uint32_t numBuckets);
+
+    void Add(float value);
+    void Merge(const cxrStatsHistogram& other); // other must have the same layout.
+    void Reset();
+
+    uint32_t Count() const { return m_count; }
+    float Min() const { return m_count ? m_min : 0.0f; }
+    float Max() const { return m_count ? m_max : 0.0f; }
+    float Mean() const { return m_count ? (float)(m_sum / m_count) : 0.0f; }
+    float Percentile(float pct) const; // pct in [0-100]
+
+private:
+    float m_minValue;
+    float m_bucketWidth;
+    std::vector<uint32_t> m_buckets;
+    uint32_t m_count = 0;
+    double m_sum = 0;
+    float m_min = 0;
+    float m_max = 0;
+};
+
+// Samples cxrGetConnectionStats on its own thread at a fixed interval, keeps
+// histograms of the values we care about for judging a network, and appends a
+// summary as one json object per line to a file every summary period, plus one
+// for the whole session when stopped.
+class cxrStatsAggregator
+{
+public:
+    static constexpr uint32_t SampleIntervalMs = 100;
+
+    ~cxrStatsAggregator() { Stop(); }
+
+    bool Start(cxrReceiverHandle receiver, const std::string& outputFile, uint32_t summaryIntervalSec);
+    // joins the sampler and writes the session summary.  must run before the receiver is destroyed.
+    void Stop();
+
+private:
+    struct Series
+    {
+        Series();
+        void Reset();
+        void Merge(const Series& other);
+
+        cxrStatsHistogram rttMs;
+        cxrStatsHistogram fps;
+        cxrStatsHistogram bitrateKbps;
+        cxrStatsHistogram lossPct;
+    };
+
+    void SamplerLoop();
+    void Sample();
+    void WriteSummary(const char* kind, const Series& series, double durationS);
+
+    cxrReceiverHandle m_receiver = nullptr;
+    FILE* m_file = nullptr;
+    uint32_t m_summaryIntervalSec = 0;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_running = false;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    double m_intervalStartS = 0;
+    Series m_interval;
+    Series m_session;
+
+    // packet counters are cumulative, loss is computed from deltas between samples.
+    uint32_t m_lastPacketsReceived = 0;
+    uint32_t m_lastPacketsLost = 0;
+    bool m_havePacketBaseline = false;
+};
+
+#endif // CLOUDXR_STATS_AGGREGATOR_H
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <chrono>
+
+#define LOG_TAG "CXRCapture"
+#include "CloudXRLog.h"
+
+#include "CloudXRTrackingCapture.h"
+
+using namespace cxrTrackingCaptureFormat;
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool cxrTrackingCapture::Start(const std::string& path)
+{
+    if (m_running)
+        return false;
+
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file)
+    {
+        CXR_LOGE("Err #%s opening tracking capture file: %s", strerror(errno), path.c_str());
+        return false;
+    }
+
+    m_path = path;
+    m_active.clear();
+    m_active.reserve(BufferBytes);
+    m_writing.clear();
+    m_writing.reserve(BufferBytes);
+    m_headerWritten = false;
+    m_records = m_dropped = m_bytes = 0;
+
+    m_running = true;
+    m_thread = std::thread([this]() { WriterLoop(); });
+    CXR_LOGI("Capturing tracking and controller input to %s", path.c_str());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrTrackingCapture::Stop()
+{
+    if (!m_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+
+    fclose(m_file);
+    m_file = nullptr;
+    CXR_LOGI("Tracking capture closed, %llu records, %llu KB, %llu dropped: %s", (unsigned long long)m_records,
+             (unsigned long long)(m_bytes / 1024), (unsigned long long)m_dropped, m_path.c_str());
+}
+
+//-----------------------------------------------------------------------------
+// The file header goes in front of the first record, so it carries the
+// capture's start time without the caller having to give one.
+//-----------------------------------------------------------------------------
+void cxrTrackingCapture::Append(const RecordHeader& header, const void* payload, uint32_t payloadBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running)
+        return;
+
+    size_t needed = sizeof(header) + payloadBytes;
+    if (!m_headerWritten)
+        needed += sizeof(FileHeader);
+    if (m_active.size() + needed > BufferBytes)
+    {
+        m_dropped++;
+        return;
+    }
+
+    if (!m_headerWritten)
+    {
+        const FileHeader fileHeader = { Magic, Version, (uint32_t)sizeof(cxrVRTrackingState),
+                                        (uint32_t)sizeof(cxrControllerEvent), header.timeNs };
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&fileHeader);
+        m_active.insert(m_active.end(), p, p + sizeof(fileHeader));
+        m_headerWritten = true;
+    }
+
+    const uint8_t* h = reinterpret_cast<const uint8_t*>(&header);
+    m_active.insert(m_active.end(), h, h + sizeof(header));
+    const uint8_t* data = static_cast<const uint8_t*>(payload);
+    m_active.insert(m_active.end(), data, data + payloadBytes);
+    m_records++;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrTrackingCapture::RecordTracking(int64_t timeNs, const cxrVRTrackingState& state)
+{
+    RecordHeader header = {};
+    header.type = Record_Tracking;
+    header.timeNs = timeNs;
+    Append(header, &state, sizeof(state));
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrTrackingCapture::RecordEvents(int64_t timeNs, uint32_t hand, const cxrControllerEvent* events, uint32_t count)
+{
+    if (count == 0)
+        return;
+    RecordHeader header = {};
+    header.type = Record_ControllerEvents;
+    header.hand = (uint8_t)hand;
+    header.count = (uint16_t)count;
+    header.timeNs = timeNs;
+    Append(header, events, count * (uint32_t)sizeof(cxrControllerEvent));
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrTrackingCapture::WriterLoop()
+{
+    prctl(PR_SET_NAME, (long)"CXR Capture", 0, 0, 0);
+
+    bool running = true;
+    while (running)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(FlushMs), [this]() { return !m_running; });
+            running = m_running;
+            m_active.swap(m_writing);
+        }
+
+        if (!m_writing.empty())
+        {
+            if (fwrite(m_writing.data(), 1, m_writing.size(), m_file) != m_writing.size())
+                CXR_LOGE("Err #%s writing tracking capture", strerror(errno));
+            m_bytes += m_writing.size();
+            m_writing.clear();
+        }
+    }
+    fflush(m_file);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool cxrTrackingReplay::Load(const std::string& path)
+{
+    m_tracking.clear();
+    m_batches.clear();
+    m_events.clear();
+    m_started = false;
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        CXR_LOGE("Err #%s opening tracking replay file: %s", strerror(errno), path.c_str());
+        return false;
+    }
+
+    FileHeader fileHeader = {};
+    if (fread(&fileHeader, sizeof(fileHeader), 1, file) != 1 || fileHeader.magic != Magic ||
+        fileHeader.version != Version)
+    {
+        CXR_LOGE("Not a tracking capture, or an unsupported version: %s", path.c_str());
+        fclose(file);
+        return false;
+    }
+    if (fileHeader.trackingStateSize != sizeof(cxrVRTrackingState) ||
+        fileHeader.controllerEventSize != sizeof(cxrControllerEvent))
+    {
+        CXR_LOGE("Tracking capture was made with a different SDK layout (%u/%u bytes, expected %u/%u): %s",
+                 fileHeader.trackingStateSize, fileHeader.controllerEventSize,
+                 (uint32_t)sizeof(cxrVRTrackingState), (uint32_t)sizeof(cxrControllerEvent), path.c_str());
+        fclose(file);
+        return false;
+    }
+    m_captureStartNs = fileHeader.startNs;
+
+    RecordHeader header;
+    bool truncated = false;
+    while (fread(&header, sizeof(header), 1, file) == 1)
+    {
+        if (header.type == Record_Tracking)
+        {
+            TrackingRecord record;
+            record.timeNs = header.timeNs;
+            if (fread(&record.state, sizeof(record.state), 1, file) != 1)
+            {
+                truncated = true;
+                break;
+            }
+            m_tracking.push_back(record);
+        }
+        else if (header.type == Record_ControllerEvents)
+        {
+            EventBatch batch = { header.timeNs, header.hand, (uint32_t)m_events.size(), header.count };
+            m_events.resize(m_events.size() + header.count);
+            if (fread(&m_events[batch.first], sizeof(cxrControllerEvent), header.count, file) != header.count)
+            {
+                m_events.resize(batch.first);
+                truncated = true;
+                break;
+            }
+            m_batches.push_back(batch);
+        }
+        else
+        {
+            truncated = true; // can't skip what we don't know the size of.
+            break;
+        }
+    }
+    fclose(file);
+
+    if (truncated)
+        CXR_LOGW("Tracking capture ends in a partial or unknown record, replaying what came before it.");
+    if (m_tracking.empty())
+    {
+        CXR_LOGE("Tracking capture has no tracking records: %s", path.c_str());
+        return false;
+    }
+
+    CXR_LOGI("Loaded tracking replay, %zu tracking records and %zu event batches over %.1f s: %s",
+             m_tracking.size(), m_batches.size(), DurationS(), path.c_str());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void cxrTrackingReplay::Start(int64_t nowNs)
+{
+    m_offsetNs = nowNs - m_captureStartNs;
+    m_trackingCursor = 0;
+    m_batchCursor = 0;
+    m_started = true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+double cxrTrackingReplay::DurationS() const
+{
+    if (m_tracking.empty())
+        return 0;
+    return (m_tracking.back().timeNs - m_captureStartNs) / 1e9;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool cxrTrackingReplay::IsFinished(int64_t nowNs) const
+{
+    return m_started && !m_tracking.empty() && nowNs - m_offsetNs > m_tracking.back().timeNs &&
+           m_batchCursor >= m_batches.size();
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool cxrTrackingReplay::TrackingAt(int64_t nowNs, cxrVRTrackingState& out)
+{
+    if (m_tracking.empty())
+        return false;
+
+    // before Start, hold the first state so the server sees the capture's opening pose.
+    if (m_started)
+    {
+        const int64_t captureNs = nowNs - m_offsetNs;
+        while (m_trackingCursor + 1 < m_tracking.size() && m_tracking[m_trackingCursor + 1].timeNs <= captureNs)
+            m_trackingCursor++;
+    }
+    out = m_tracking[m_trackingCursor].state;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool cxrTrackingReplay::NextEvents(int64_t nowNs, uint32_t& hand, std::vector<cxrControllerEvent>& events)
+{
+    if (!m_started || m_batchCursor >= m_batches.size())
+        return false;
+
+    const EventBatch& batch = m_batches[m_batchCursor];
+    if (batch.timeNs > nowNs - m_offsetNs)
+        return false;
+
+    hand = batch.hand;
+    events.assign(m_events.begin() + batch.first, m_events.begin() + batch.first + batch.count);
+    for (auto& e : events)
+        e.clientTimeNS = (uint64_t)((int64_t)e.clientTimeNS + m_offsetNs);
+    m_batchCursor++;
+    return true;
+}
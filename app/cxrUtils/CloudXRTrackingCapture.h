@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLOUDXR_TRACKING_CAPTURE_H
+#define CLOUDXR_TRACKING_CAPTURE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "CloudXRClient.h"
+
+// On-disk layout shared by capture and replay.  Records are written as they
+// happen: a tracking state per poll, and a batch of controller events per hand
+// whenever a poll produced any.  Structs are stored raw, so the header carries
+// their sizes and a file only replays on a build with the same SDK layout.
+namespace cxrTrackingCaptureFormat
+{
+    static const uint32_t Magic = 0x54525843; // "CXRT"
+    static const uint32_t Version = 1;
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t trackingStateSize;
+        uint32_t controllerEventSize;
+        int64_t startNs;        // capture clock at the first record.
+    };
+
+    typedef enum : uint8_t
+    {
+        Record_Tracking = 1,
+        Record_ControllerEvents = 2,
+    } RecordType;
+
+    struct RecordHeader
+    {
+        uint8_t type;
+        uint8_t hand;           // events only.
+        uint16_t count;         // events only.
+        uint32_t reserved;
+        int64_t timeNs;
+    };
+}
+
+// Capture side.  The tracking path only copies into a preallocated buffer
+// under a short lock; a writer thread swaps buffers and does the file i/o.  A
+// full buffer drops the record and counts it, it never waits for the disk.
+class cxrTrackingCapture
+{
+public:
+    static constexpr uint32_t BufferBytes = 256 * 1024;
+    static constexpr uint32_t FlushMs = 250;
+
+    ~cxrTrackingCapture() { Stop(); }
+
+    bool Start(const std::string& path);
+    void Stop(); // flushes and closes.
+    bool IsRecording() const { return m_running.load(std::memory_order_relaxed); }
+
+    void RecordTracking(int64_t timeNs, const cxrVRTrackingState& state);
+    void RecordEvents(int64_t timeNs, uint32_t hand, const cxrControllerEvent* events, uint32_t count);
+
+private:
+    void Append(const cxrTrackingCaptureFormat::RecordHeader& header, const void* payload, uint32_t payloadBytes);
+    void WriterLoop();
+
+    FILE* m_file = nullptr;
+    std::string m_path;
+    std::vector<uint8_t> m_active;  // appended to by the tracking path.
+    std::vector<uint8_t> m_writing; // owned by the writer while it's out.
+    bool m_headerWritten = false;
+    uint64_t m_records = 0;
+    uint64_t m_dropped = 0;
+    uint64_t m_bytes = 0;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_running{false};
+};
+
+// Replay side.  The whole file is loaded up front, then played back against
+// the caller's clock from Start.  Tracking returns whichever state was current
+// at that point in the capture, events come out once each as their time comes.
+// One thread only, the same one that would otherwise poll the real devices.
+class cxrTrackingReplay
+{
+public:
+    bool Load(const std::string& path);
+    bool IsLoaded() const { return !m_tracking.empty(); }
+
+    void Start(int64_t nowNs);
+    // back to before Start, so the next Start plays from the beginning.
+    void Rewind() { m_started = false; m_trackingCursor = 0; m_batchCursor = 0; }
+    bool IsStarted() const { return m_started; }
+    bool IsFinished(int64_t nowNs) const;
+    double DurationS() const;
+
+    // false before anything was recorded, which Load rules out once Start was called.
+    bool TrackingAt(int64_t nowNs, cxrVRTrackingState& out);
+    // the next batch due by nowNs, event times moved onto the replay clock.  false when none are due.
+    bool NextEvents(int64_t nowNs, uint32_t& hand, std::vector<cxrControllerEvent>& events);
+
+private:
+    struct TrackingRecord
+    {
+        int64_t timeNs;
+        cxrVRTrackingState state;
+    };
+    struct EventBatch
+    {
+        int64_t timeNs;
+        uint32_t hand;
+        uint32_t first; // into m_events.
+        uint32_t count;
+    };
+
+    std::vector<TrackingRecord> m_tracking;
+    std::vector<EventBatch> m_batches;
+    std::vector<cxrControllerEvent> m_events;
+    int64_t m_captureStartNs = 0;
+    int64_t m_offsetNs = 0;     // replay clock minus capture clock.
+    size_t m_trackingCursor = 0;
+    size_t m_batchCursor = 0;
+    bool m_started = false;
+};
+
+#endif // CLOUDXR_TRACKING_CAPTURE_H
@@ -28,7 +28,25 @@ LOCAL_C_INCLUDES := $(OVR_SDK_ROOT)/1stParty/OVR/Include \
 
 LOCAL_SRC_FILES := ../src/main.cpp \
                    ../src/EGLHelper.cpp \
-                   $(C_SHARED_INCLUDE)/CloudXRFileLogger.cpp
+                   ../src/SwapChainPool.cpp \
+                   ../src/ControllerRegistry.cpp \
+                   ../src/HapticScheduler.cpp \
+                   ../src/AudioCapture.cpp \
+                   ../src/FrameTiming.cpp \
+                   ../src/GpuTimer.cpp \
+                   ../src/StartupTimeline.cpp \
+                   ../src/ControlChannel.cpp \
+                   ../src/LatencyTest.cpp \
+                   ../src/StatsHud.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRFileLogger.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRStatsAggregator.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRServerProbe.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRTrackingCapture.cpp \
+                   $(C_SHARED_INCLUDE)/CloudXRLogDeferred.cpp
+
+# 1 compiles out CXR_LOGV, 2 also CXR_LOGD.  e.g. ndk-build CXR_LOG_COMPILE_FLOOR=2
+CXR_LOG_COMPILE_FLOOR ?= 0
+LOCAL_CFLAGS += -DCXR_LOG_COMPILE_FLOOR=$(CXR_LOG_COMPILE_FLOOR)
 
 LOCAL_LDLIBS := -llog -landroid -lGLESv3 -lEGL
 LOCAL_STATIC_LIBRARIES	:= android_native_app_glue
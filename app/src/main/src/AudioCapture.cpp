@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "AudioCapture.h"
+#define LOG_TAG "AudioCapture"
+#include "CloudXRLog.h"
+
+#include <string.h>
+#include <time.h>
+#include <sys/prctl.h>
+#include <chrono>
+
+// same clock the capture callback stamps with.
+static int64_t NowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void AudioCapture::Start(cxrReceiverHandle receiver, const std::atomic<cxrClientState>* state,
+                         uint32_t channels, uint32_t sampleRate, uint32_t frameMs)
+{
+    if (mThread.joinable() || !receiver || !channels || !sampleRate || !frameMs)
+        return;
+
+    mReceiver = receiver;
+    mState = state;
+    mChannels = channels;
+    mSampleRate = sampleRate;
+    mPacketFrames = sampleRate * frameMs / 1000;
+
+    uint32_t capacity = 1;
+    while (capacity < sampleRate * RingMs / 1000)
+        capacity <<= 1;
+    mMask = capacity - 1;
+    mRing.assign((size_t)capacity * channels, 0);
+    mPacket.assign((size_t)mPacketFrames * channels, 0);
+
+    mWritePos = 0;
+    mReadPos = 0;
+    mLastWrite.Store(WriteStamp{0, 0});
+    mDroppedBursts = 0;
+    mDroppedFrames = 0;
+    mSentPackets = 0;
+    mLatePackets = 0;
+    mFailedPackets = 0;
+    mDiscardedPackets = 0;
+    mMaxLateMs = 0;
+
+    mRunning = true;
+    mThread = std::thread([this]() { SenderLoop(); });
+    mAccepting = true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void AudioCapture::Stop()
+{
+    if (!mThread.joinable())
+        return;
+
+    // the callback may be mid-Push, but it only touches the ring, which lives
+    // until the next Start.  the sender is the only one calling the receiver.
+    mAccepting = false;
+    mRunning = false;
+    mThread.join();
+
+    const uint32_t droppedBursts = mDroppedBursts;
+    CXR_LOGI("Mic: sent %u packets of %u frames, %u late (worst %.1f ms), %u failed, %u discarded while not streaming.",
+             mSentPackets, mPacketFrames, mLatePackets, mMaxLateMs, mFailedPackets, mDiscardedPackets);
+    if (droppedBursts)
+        CXR_LOGW("Mic: dropped %u capture bursts (%u frames), sender fell behind.",
+                 droppedBursts, (uint32_t)mDroppedFrames);
+
+    mReceiver = nullptr;
+    mState = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void AudioCapture::Push(const int16_t* samples, uint32_t frames, int64_t nowNs)
+{
+    if (!mAccepting.load(std::memory_order_acquire) || frames == 0)
+        return;
+
+    const uint64_t w = mWritePos.load(std::memory_order_relaxed);
+    const uint64_t r = mReadPos.load(std::memory_order_acquire);
+    if (w - r + frames > mMask + 1)
+    {
+        mDroppedBursts.fetch_add(1, std::memory_order_relaxed);
+        mDroppedFrames.fetch_add(frames, std::memory_order_relaxed);
+        return;
+    }
+
+    const uint32_t start = (uint32_t)(w & mMask);
+    const uint32_t first = (frames < mMask + 1 - start) ? frames : (mMask + 1 - start);
+    memcpy(&mRing[(size_t)start * mChannels], samples, (size_t)first * mChannels * sizeof(int16_t));
+    if (first < frames)
+        memcpy(&mRing[0], samples + (size_t)first * mChannels, (size_t)(frames - first) * mChannels * sizeof(int16_t));
+
+    // stamp first, so a sender that sees the new write position never pairs it with the old stamp.
+    mLastWrite.Store(WriteStamp{w + frames, nowNs});
+    mWritePos.store(w + frames, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+// Wakes at half a packet period and sends every complete packet in the ring.
+// Polling keeps the callback free of any wake-up: it never locks or signals.
+//-----------------------------------------------------------------------------
+void AudioCapture::SenderLoop()
+{
+    prctl(PR_SET_NAME, (long)"CXR Mic", 0, 0, 0);
+
+    const double packetMs = mPacketFrames * 1000.0 / mSampleRate;
+    const auto period = std::chrono::microseconds((int64_t)(packetMs * 500.0));
+
+    while (mRunning)
+    {
+        std::this_thread::sleep_for(period);
+
+        const uint64_t w = mWritePos.load(std::memory_order_acquire);
+        uint64_t r = mReadPos.load(std::memory_order_relaxed);
+        if (w - r < mPacketFrames)
+            continue;
+
+        WriteStamp stamp;
+        mLastWrite.Load(stamp);
+        const bool streaming = mState && mState->load() == cxrClientState_StreamingSessionInProgress;
+
+        while (w - r >= mPacketFrames)
+        {
+            const uint32_t start = (uint32_t)(r & mMask);
+            const uint32_t first = (mPacketFrames < mMask + 1 - start) ? mPacketFrames : (mMask + 1 - start);
+            memcpy(mPacket.data(), &mRing[(size_t)start * mChannels], (size_t)first * mChannels * sizeof(int16_t));
+            if (first < mPacketFrames)
+                memcpy(mPacket.data() + (size_t)first * mChannels, &mRing[0],
+                       (size_t)(mPacketFrames - first) * mChannels * sizeof(int16_t));
+            r += mPacketFrames;
+            mReadPos.store(r, std::memory_order_release);
+
+            if (!streaming)
+            {
+                mDiscardedPackets++;
+                continue;
+            }
+
+            // the packet's last frame was captured this long before the newest write landed.
+            // a stamp older than the packet can't date it, so the packet just isn't aged.
+            if (stamp.endFrame >= r)
+            {
+                const int64_t captureNs = stamp.timeNs - (int64_t)((stamp.endFrame - r) * 1000000000ULL / mSampleRate);
+                const float lateMs = (float)((NowNs() - captureNs) / 1000000.0);
+                if (lateMs > packetMs)
+                {
+                    mLatePackets++;
+                    if (lateMs > mMaxLateMs)
+                        mMaxLateMs = lateMs;
+                }
+            }
+
+            cxrAudioFrame frame{};
+            frame.streamBuffer = mPacket.data();
+            frame.streamSizeBytes = mPacketFrames * mChannels * sizeof(int16_t);
+            if (cxrSendAudio(mReceiver, &frame) == cxrError_Success)
+                mSentPackets++;
+            else
+                mFailedPackets++;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_AUDIOCAPTURE_H
+#define CLIENT_APP_OVR_AUDIOCAPTURE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "CloudXRClient.h"
+#include "CloudXRSeqLock.h"
+
+// Microphone path from the Oboe input callback to the receiver.  The real-time
+// callback only copies into a preallocated ring; a sender thread cuts the ring
+// into fixed-size packets matching the encoder frame and hands them to
+// cxrSendAudio, so device burst sizes and library work never meet on the
+// audio thread.  Packets are only sent while the session is streaming, and the
+// callback stops accepting audio before the receiver can go away.
+class AudioCapture
+{
+public:
+    static constexpr uint32_t RingMs = 500;   // how much capture can back up before we drop.
+
+    ~AudioCapture() { Stop(); }
+
+    // receiver must outlive Stop.  nothing is sent unless *state is streaming.
+    void Start(cxrReceiverHandle receiver, const std::atomic<cxrClientState>* state,
+               uint32_t channels, uint32_t sampleRate, uint32_t frameMs);
+    // joins the sender, after which the callback drops everything.
+    void Stop();
+
+    // real-time safe, from the input stream callback.
+    void Push(const int16_t* samples, uint32_t frames, int64_t nowNs);
+
+private:
+    struct WriteStamp
+    {
+        uint64_t endFrame;  // ring position after the write.
+        int64_t timeNs;     // when it was written.
+    };
+
+    void SenderLoop();
+
+    cxrReceiverHandle mReceiver = nullptr;
+    const std::atomic<cxrClientState>* mState = nullptr;
+    uint32_t mChannels = 0;
+    uint32_t mSampleRate = 0;
+    uint32_t mPacketFrames = 0;
+
+    std::vector<int16_t> mRing;
+    std::vector<int16_t> mPacket;   // sender only.
+    uint32_t mMask = 0;
+    std::atomic<uint64_t> mWritePos{0};
+    std::atomic<uint64_t> mReadPos{0};
+    cxrSeqLock<WriteStamp> mLastWrite; // the callback is the one writer.
+
+    std::thread mThread;
+    std::atomic<bool> mRunning{false};
+    std::atomic<bool> mAccepting{false};
+
+    // callback-side
+    std::atomic<uint32_t> mDroppedBursts{0};
+    std::atomic<uint32_t> mDroppedFrames{0};
+    // sender-side
+    uint32_t mSentPackets = 0;
+    uint32_t mLatePackets = 0;      // more than a packet's length after capture.
+    uint32_t mFailedPackets = 0;    // cxrSendAudio errors.
+    uint32_t mDiscardedPackets = 0; // captured while not streaming.
+    float mMaxLateMs = 0;
+};
+
+#endif //CLIENT_APP_OVR_AUDIOCAPTURE_H
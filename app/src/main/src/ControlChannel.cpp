@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ControlChannel.h"
+#define LOG_TAG "Control"
+#include "CloudXRLog.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+
+static const uid_t AID_ROOT = 0;
+static const uid_t AID_SHELL = 2000; // what adb forwards connect as.
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool ControlChannel::Start(const std::string& name, std::function<void()> onCommand)
+{
+    if (mRunning || name.empty())
+        return false;
+
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    // abstract namespace: leading nul, no file, gone with the process.
+    const size_t nameLen = std::min(name.size(), sizeof(addr.sun_path) - 1);
+    memcpy(addr.sun_path + 1, name.c_str(), nameLen);
+    const socklen_t addrLen = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + nameLen);
+
+    mListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (mListenFd < 0 || bind(mListenFd, (struct sockaddr*)&addr, addrLen) != 0 || listen(mListenFd, 1) != 0 ||
+        pipe2(mWakeFds, O_CLOEXEC) != 0)
+    {
+        CXR_LOGE("Unable to listen for control commands on %s, error = %d", name.c_str(), errno);
+        if (mListenFd >= 0)
+            close(mListenFd);
+        mListenFd = -1;
+        return false;
+    }
+
+    mName = name;
+    mOnCommand = onCommand;
+    mRunning = true;
+    mThread = std::thread([this]() { ListenLoop(); });
+    CXR_LOGI("Listening for control commands on localabstract:%s", name.c_str());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void ControlChannel::Stop()
+{
+    if (!mRunning)
+        return;
+
+    mRunning = false;
+    const char wake = 1;
+    if (write(mWakeFds[1], &wake, 1) < 0)
+        CXR_LOGW("Unable to wake the control listener, error = %d", errno);
+    if (mThread.joinable())
+        mThread.join();
+
+    CloseClient();
+    close(mListenFd);
+    close(mWakeFds[0]);
+    close(mWakeFds[1]);
+    mListenFd = mWakeFds[0] = mWakeFds[1] = -1;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLines.clear();
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool ControlChannel::Pop(std::string& line)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mLines.empty())
+        return false;
+    line = std::move(mLines.front());
+    mLines.pop_front();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void ControlChannel::Reply(const std::string& text)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mClientFd < 0)
+        return;
+    const std::string line = text + "\n";
+    // replies are short enough to always fit the socket buffer of a reader
+    // that keeps up.  one that doesn't just misses them.
+    send(mClientFd, line.c_str(), line.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void ControlChannel::ListenLoop()
+{
+    prctl(PR_SET_NAME, (long)"CXR Control", 0, 0, 0);
+
+    while (mRunning)
+    {
+        struct pollfd fds[3] = {
+            { mWakeFds[0], POLLIN, 0 },
+            { mListenFd, POLLIN, 0 },
+            { mClientFd, POLLIN, 0 }, // ignored while negative.
+        };
+        if (poll(fds, 3, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            CXR_LOGE("Control channel poll failed, error = %d", errno);
+            break;
+        }
+
+        if (fds[0].revents)
+            break;
+        if ((fds[1].revents & POLLIN) && !AcceptClient())
+            continue;
+        if (fds[2].revents && !ReadClient())
+            CloseClient();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// A new connection replaces the old one, so a stale adb session never locks
+// everyone out.
+//-----------------------------------------------------------------------------
+bool ControlChannel::AcceptClient()
+{
+    const int fd = accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct ucred peer = {};
+    socklen_t len = sizeof(peer);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &len) != 0 ||
+        (peer.uid != AID_ROOT && peer.uid != AID_SHELL && peer.uid != getuid()))
+    {
+        CXR_LOGW("Control connection from uid %d refused.", (int)peer.uid);
+        close(fd);
+        return false;
+    }
+
+    CloseClient();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClientFd = fd;
+    }
+    mPartial.clear();
+    CXR_LOGI("Control client connected, uid %d.", (int)peer.uid);
+    Reply("cloudxr client control, send options as on the command line, or 'reconnect'.");
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// false once the client closed or sent something we won't take.
+//-----------------------------------------------------------------------------
+bool ControlChannel::ReadClient()
+{
+    char buf[1024];
+    const ssize_t got = recv(mClientFd, buf, sizeof(buf), 0);
+    if (got <= 0)
+        return (got < 0 && (errno == EINTR || errno == EAGAIN));
+
+    bool queued = false;
+    for (ssize_t i = 0; i < got; ++i)
+    {
+        const char c = buf[i];
+        if (c == '\r')
+            continue;
+        if (c != '\n')
+        {
+            mPartial.push_back(c);
+            if (mPartial.size() > MaxLineBytes)
+            {
+                CXR_LOGW("Control line over %u bytes, dropping the client.", MaxLineBytes);
+                return false;
+            }
+            continue;
+        }
+
+        if (!mPartial.empty())
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mLines.push_back(std::move(mPartial));
+            queued = true;
+        }
+        mPartial.clear();
+    }
+
+    if (queued && mOnCommand)
+        mOnCommand();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void ControlChannel::CloseClient()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mClientFd < 0)
+        return;
+    close(mClientFd);
+    mClientFd = -1;
+    CXR_LOGI("Control client disconnected.");
+}
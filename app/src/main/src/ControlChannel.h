@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_CONTROLCHANNEL_H
+#define CLIENT_APP_OVR_CONTROLCHANNEL_H
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Line-based command socket for changing options on a running client.  Listens
+// in the abstract local namespace, so nothing is exposed on the network: the
+// usual way in is `adb forward tcp:<port> localabstract:<name>`, then any tcp
+// client.  One connection at a time, from the shell, root or our own uid.  The
+// listener thread only queues lines, the owner pops and answers them on its
+// own thread, so commands never race the state they change.
+class ControlChannel
+{
+public:
+    static constexpr uint32_t MaxLineBytes = 4096;
+
+    ~ControlChannel() { Stop(); }
+
+    // onCommand is called from the listener thread whenever a line is queued.
+    bool Start(const std::string& name, std::function<void()> onCommand);
+    void Stop();
+    bool IsRunning() const { return mRunning; }
+
+    // next queued line, false if there's none.
+    bool Pop(std::string& line);
+    // to whoever is connected now, dropped if they've gone.  never blocks.
+    void Reply(const std::string& text);
+
+private:
+    void ListenLoop();
+    bool AcceptClient();
+    bool ReadClient();
+    void CloseClient();
+
+    std::function<void()> mOnCommand;
+    std::string mName;
+    int mListenFd = -1;
+    int mWakeFds[2] = { -1, -1 }; // written by Stop to get the listener out of poll.
+    int mClientFd = -1;           // guarded by mMutex for Reply, only closed by the listener.
+    std::string mPartial;         // listener only, a line still being received.
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::deque<std::string> mLines;
+    std::atomic<bool> mRunning{false};
+};
+
+#endif //CLIENT_APP_OVR_CONTROLCHANNEL_H
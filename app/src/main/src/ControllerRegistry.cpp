@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ControllerRegistry.h"
+#define LOG_TAG "ControllerRegistry"
+#include "CloudXRLog.h"
+
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool ControllerRegistry::Refresh(ovrMobile* session)
+{
+    std::lock_guard<std::mutex> lock(mRefreshMutex);
+
+    Snapshot prior;
+    mPublished.Load(prior);
+
+    Snapshot next;
+    memset(&next, 0, sizeof(next));
+
+    uint32_t deviceIndex = 0;
+    ovrInputCapabilityHeader capsHeader;
+    while (session && vrapi_EnumerateInputDevices(session, deviceIndex, &capsHeader) >= 0)
+    {
+        ++deviceIndex;
+        if (capsHeader.Type != ovrControllerType_TrackedRemote)
+            continue;
+
+        ovrInputTrackedRemoteCapabilities remoteCaps;
+        remoteCaps.Header = capsHeader;
+        if (vrapi_GetInputDeviceCapabilities(session, &remoteCaps.Header) < 0)
+            continue;
+        // this code has removed all support for non Touch controllers.
+        if (0 == (remoteCaps.ControllerCapabilities & ovrControllerCaps_ModelOculusTouch))
+            continue;
+
+        const uint32_t hand = (remoteCaps.ControllerCapabilities & ovrControllerCaps_RightHand) ? 1 : 0;
+        Controller& c = next.hands[hand];
+        if (!c.present)
+            next.count++;
+        c.present = true;
+        c.deviceID = capsHeader.DeviceID;
+        c.controllerCaps = remoteCaps.ControllerCapabilities;
+        c.buttonCaps = remoteCaps.ButtonCapabilities;
+        c.touchCaps = remoteCaps.TouchCapabilities;
+        if (remoteCaps.ControllerCapabilities & ovrControllerCaps_HasBufferedHapticVibration)
+        {
+            c.hapticSamplesMax = remoteCaps.HapticSamplesMax;
+            c.hapticSampleDurationMS = remoteCaps.HapticSampleDurationMS;
+        }
+    }
+
+    bool changed = false;
+    for (uint32_t hand = 0; hand < MaxHands; ++hand)
+    {
+        const Controller& was = prior.hands[hand];
+        const Controller& now = next.hands[hand];
+        if (0 == memcmp(&was, &now, sizeof(Controller)))
+            continue;
+        changed = true;
+        if (now.present)
+            CXR_LOGI("Controller %s is device %u, caps 0x%08x, haptic samples %u @ %ums",
+                hand ? "right" : "left", now.deviceID, now.controllerCaps,
+                now.hapticSamplesMax, now.hapticSampleDurationMS);
+        else
+            CXR_LOGI("Controller %s went away", hand ? "right" : "left");
+    }
+
+    if (changed)
+        mPublished.Store(next);
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool ControllerRegistry::RefreshIfDue(ovrMobile* session, double nowS)
+{
+    if (!mDirty.exchange(false) && nowS - mLastRefreshS < RefreshIntervalS)
+        return false;
+    mLastRefreshS = nowS;
+    return Refresh(session);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void ControllerRegistry::Clear()
+{
+    std::lock_guard<std::mutex> lock(mRefreshMutex);
+    Snapshot empty;
+    memset(&empty, 0, sizeof(empty));
+    mPublished.Store(empty);
+    mDirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool ControllerRegistry::FindByDeviceID(ovrDeviceID deviceID, Controller& out, uint32_t* handOut) const
+{
+    Snapshot snap;
+    mPublished.Load(snap);
+    for (uint32_t hand = 0; hand < MaxHands; ++hand)
+    {
+        if (!snap.hands[hand].present || snap.hands[hand].deviceID != deviceID)
+            continue;
+        out = snap.hands[hand];
+        if (handOut)
+            *handOut = hand;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_CONTROLLERREGISTRY_H
+#define CLIENT_APP_OVR_CONTROLLERREGISTRY_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+#include "VrApi.h"
+#include "VrApi_Input.h"
+
+#include "CloudXRSeqLock.h"
+
+// Cache of the tracked remotes vrapi knows about, keyed by hand.  Enumerating
+// devices and querying capabilities is far too slow to do on every pose poll
+// or haptic request, and vrapi DeviceIDs are handed out incrementally, so the
+// same physical controller can come back under a new ID after sleeping.  Hand
+// index is the stable identity, the DeviceID is just re-resolved on refresh.
+// Refresh may be called from any thread, lookups are lock free.
+class ControllerRegistry
+{
+public:
+    static constexpr uint32_t MaxHands = 2;
+    static constexpr double RefreshIntervalS = 2.0; // catch wake/sleep, vrapi has no event for it.
+
+    struct Controller
+    {
+        bool present;
+        ovrDeviceID deviceID;
+        uint32_t controllerCaps;  // ovrControllerCaps bits
+        uint32_t buttonCaps;
+        uint32_t touchCaps;
+        uint32_t hapticSamplesMax;   // 0 when no buffered haptics.
+        uint32_t hapticSampleDurationMS;
+    };
+
+    struct Snapshot
+    {
+        Controller hands[MaxHands];
+        uint32_t count;
+    };
+
+    // enumerates now, returns true if the set of controllers changed.
+    bool Refresh(ovrMobile* session);
+    // refreshes only if invalidated or the slow timer expired.
+    bool RefreshIfDue(ovrMobile* session, double nowS);
+    // any thread, forces the next RefreshIfDue to enumerate.
+    void Invalidate() { mDirty = true; }
+    void Clear();
+
+    // lock-free reads of the last published snapshot.
+    void Get(Snapshot& out) const { mPublished.Load(out); }
+    bool FindByDeviceID(ovrDeviceID deviceID, Controller& out, uint32_t* handOut = nullptr) const;
+
+private:
+    std::mutex mRefreshMutex; // serializes writers, the seqlock allows only one.
+    cxrSeqLock<Snapshot> mPublished;
+    std::atomic<bool> mDirty{true};
+    std::atomic<double> mLastRefreshS{0};
+};
+
+#endif //CLIENT_APP_OVR_CONTROLLERREGISTRY_H
@@ -97,6 +97,60 @@ bool EGLHelper::Initialize()
     return true;
 }
 
+//-----------------------------------------------------------------------------
+bool EGLHelper::InitializeShared(const EGLHelper& parent)
+{
+    if (mContext != 0)
+        return true; // already initialized
+
+    if (parent.mContext == 0 || mDisplay == 0)
+    {
+        CXR_LOGE("EGLHelper: parent context must be initialized before sharing.");
+        return false;
+    }
+
+    const EGLDisplay display = (EGLDisplay)mDisplay;
+    const EGLConfig config = (EGLConfig)parent.mConfig;
+
+    static EGLint contextAttrs[] =
+    {
+            EGL_CONTEXT_CLIENT_VERSION, 3,
+            EGL_NONE,
+    };
+
+    EGLContext context = eglCreateContext(display, config, (EGLContext)parent.mContext, contextAttrs);
+    if (context == nullptr)
+    {
+        CXR_LOGE("EGLHelper: CreateContext for shared context failed.");
+        return false;
+    }
+
+    static EGLint pbufferAttrs[] =
+    {
+            EGL_WIDTH, 4,
+            EGL_HEIGHT, 4,
+            EGL_NONE,
+    };
+
+    const EGLSurface surface = eglCreatePbufferSurface(display, config, pbufferAttrs);
+    if (surface == nullptr)
+    {
+        CXR_LOGE("EGLHelper unable to create pbuffer surface for shared context");
+        eglDestroyContext(display, context);
+        return false;
+    }
+
+    CXR_LOGV("EGLHelper using shared pbuffer context");
+    mConfig = parent.mConfig;
+    mContext = (Handle)context;
+    mSurface = (Handle)surface;
+    mShared = true;
+
+    MakeCurrent();
+
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 void EGLHelper::Release()
 {
@@ -115,11 +169,13 @@ void EGLHelper::Release()
         mSurface = 0;
     }
 
-    if (mDisplay)
+    // the display belongs to the primary context.
+    if (mDisplay && !mShared)
     {
         eglTerminate((EGLDisplay)mDisplay);
         mDisplay = 0;
     }
+    mShared = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -33,6 +33,8 @@ public:
     typedef intptr_t Handle;
 
     bool Initialize();
+    // creates a context in the same share group as parent, for use on another thread.
+    bool InitializeShared(const EGLHelper& parent);
     void Release();
     bool IsValid() { return mContext != 0 && mSurface != 0; }
 
@@ -54,6 +56,7 @@ private:
     Handle mContext = 0;
     Handle mSurface = 0;
     Handle mConfig = 0;
+    bool mShared = false; // shared contexts don't own the display.
 
     struct HelperEGLConfig
     {
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FrameTiming.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+
+#define LOG_TAG "FrameTiming"
+#include "CloudXRLog.h"
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool FrameTimingRecorder::WriteCsv(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        CXR_LOGE("Err #%s opening frame timing file: %s", strerror(errno), path.c_str());
+        return false;
+    }
+
+    fprintf(file, "frame,kind,latch_start_s,display_time_s,latch_wait_ms,blit_ms,submit_ms,pose_age_ms,fence_wait_ms,gpu_left_ms,gpu_right_ms\n");
+
+    const uint32_t size = Size();
+    const uint64_t first = mCount - size;
+    for (uint64_t i = first; i < mCount; ++i)
+    {
+        const FrameTimingRecord& r = mRecords[i & (Capacity - 1)];
+        fprintf(file, "%llu,%d,%.6f,%.6f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                (unsigned long long)r.frameIndex, (int)r.kind, r.latchStartS, r.displayTimeS,
+                r.latchWaitMs, r.blitMs, r.submitMs, r.poseAgeMs, r.fenceWaitMs, r.gpuEyeMs[0], r.gpuEyeMs[1]);
+    }
+
+    fclose(file);
+    CXR_LOGI("Wrote %d frame timings to %s", size, path.c_str());
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_FRAMETIMING_H
+#define CLIENT_APP_OVR_FRAMETIMING_H
+
+#include <stdint.h>
+#include <string>
+
+#include <android/trace.h>
+
+// ATrace section for the enclosing scope, shows up in systrace/Perfetto
+// captures with the app's atrace category enabled.  Near free when not tracing.
+class ScopedTrace
+{
+public:
+    explicit ScopedTrace(const char* name) { ATrace_beginSection(name); }
+    ~ScopedTrace() { ATrace_endSection(); }
+};
+
+typedef enum
+{
+    FrameKind_Streamed = 0,     // new frame latched and blitted
+    FrameKind_Repeated = 1,     // last frame resubmitted for reprojection
+    FrameKind_Background = 2,   // nothing to show, background fill
+} FrameKind;
+
+struct FrameTimingRecord
+{
+    uint64_t frameIndex;
+    double latchStartS;     // all times on the GetTimeInSeconds() clock
+    double displayTimeS;    // predicted display time we submitted for
+    float latchWaitMs;
+    float blitMs;
+    float submitMs;
+    float poseAgeMs;        // age of the newest tracking sample sent to the server, at latch end
+    float fenceWaitMs;      // waiting for the GPU to catch up before latching
+    float gpuEyeMs[2];      // GPU blit or fill per eye, filled in a few frames later.  < 0 if not timed
+    FrameKind kind;
+};
+
+// Fixed size ring of the most recent frames' timings.  Push never allocates or
+// locks, so it's safe to leave on in the render loop; only the render thread
+// touches it.  WriteCsv is for dumping after the fact, oldest frame first.
+class FrameTimingRecorder
+{
+public:
+    static constexpr uint32_t Capacity = 1024; // power of two, ~11s at 90hz.
+
+    void Push(const FrameTimingRecord& record)
+    {
+        mRecords[mCount & (Capacity - 1)] = record;
+        mCount++;
+    }
+
+    // a recent frame's record, for results that arrive late.  null once it's out of the ring.
+    FrameTimingRecord* Find(uint64_t frameIndex)
+    {
+        for (uint64_t i = mCount; i > 0 && mCount - i < Capacity; --i)
+        {
+            FrameTimingRecord& r = mRecords[(i - 1) & (Capacity - 1)];
+            if (r.frameIndex == frameIndex)
+                return &r;
+            if (r.frameIndex < frameIndex)
+                break;
+        }
+        return nullptr;
+    }
+
+    uint32_t Size() const { return (mCount < Capacity) ? (uint32_t)mCount : Capacity; }
+    void Clear() { mCount = 0; }
+
+    bool WriteCsv(const std::string& path) const;
+
+private:
+    FrameTimingRecord mRecords[Capacity];
+    uint64_t mCount = 0; // total pushed, next slot is mCount % Capacity.
+};
+
+#endif //CLIENT_APP_OVR_FRAMETIMING_H
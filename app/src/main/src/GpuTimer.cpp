@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GpuTimer.h"
+#define LOG_TAG "GpuTimer"
+#include "CloudXRLog.h"
+
+#include <string.h>
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+// entry points are per process, resolve them once.
+static PFNGLGENQUERIESEXTPROC s_glGenQueriesEXT = nullptr;
+static PFNGLDELETEQUERIESEXTPROC s_glDeleteQueriesEXT = nullptr;
+static PFNGLBEGINQUERYEXTPROC s_glBeginQueryEXT = nullptr;
+static PFNGLENDQUERYEXTPROC s_glEndQueryEXT = nullptr;
+static PFNGLGETQUERYOBJECTUIVEXTPROC s_glGetQueryObjectuivEXT = nullptr;
+static PFNGLGETQUERYOBJECTUI64VEXTPROC s_glGetQueryObjectui64vEXT = nullptr;
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+static bool HasExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (ext && strcmp(ext, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool GpuTimer::Initialize()
+{
+    if (mAvailable)
+        return true;
+
+    if (!HasExtension("GL_EXT_disjoint_timer_query"))
+    {
+        CXR_LOGI("GL_EXT_disjoint_timer_query not supported, no GPU timings.");
+        return false;
+    }
+
+    s_glGenQueriesEXT = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+    s_glDeleteQueriesEXT = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+    s_glBeginQueryEXT = (PFNGLBEGINQUERYEXTPROC)eglGetProcAddress("glBeginQueryEXT");
+    s_glEndQueryEXT = (PFNGLENDQUERYEXTPROC)eglGetProcAddress("glEndQueryEXT");
+    s_glGetQueryObjectuivEXT = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+    s_glGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    if (!s_glGenQueriesEXT || !s_glDeleteQueriesEXT || !s_glBeginQueryEXT || !s_glEndQueryEXT ||
+        !s_glGetQueryObjectuivEXT || !s_glGetQueryObjectui64vEXT)
+    {
+        CXR_LOGE("GL_EXT_disjoint_timer_query advertised but entry points missing.");
+        return false;
+    }
+
+    s_glGenQueriesEXT(Latency * MaxScopes, &mQueries[0][0]);
+    memset(mSlots, 0, sizeof(mSlots));
+    mDropped = 0;
+
+    // clear any disjoint flagged before we started.
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    mAvailable = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void GpuTimer::Release()
+{
+    if (!mAvailable)
+        return;
+    s_glDeleteQueriesEXT(Latency * MaxScopes, &mQueries[0][0]);
+    memset(mQueries, 0, sizeof(mQueries));
+    mAvailable = false;
+}
+
+//-----------------------------------------------------------------------------
+// The slot about to be reused holds the frame from Latency frames ago.
+//-----------------------------------------------------------------------------
+bool GpuTimer::BeginFrame(uint64_t frameIndex, Result& out)
+{
+    if (!mAvailable)
+        return false;
+
+    mCurrent = (uint32_t)(frameIndex % Latency);
+    Slot& slot = mSlots[mCurrent];
+    bool resolved = false;
+
+    if (slot.pending)
+    {
+        // disjoint is sticky until read, and covers everything in flight.
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+        bool complete = true;
+        for (uint32_t s = 0; s < MaxScopes && complete; ++s)
+        {
+            if (!slot.used[s])
+                continue;
+            GLuint available = 0;
+            s_glGetQueryObjectuivEXT(mQueries[mCurrent][s], GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+            complete = (available != 0);
+        }
+
+        if (complete && !disjoint)
+        {
+            out.frameIndex = slot.frameIndex;
+            for (uint32_t s = 0; s < MaxScopes; ++s)
+            {
+                out.ms[s] = -1.0f;
+                if (!slot.used[s])
+                    continue;
+                GLuint64 elapsedNs = 0;
+                s_glGetQueryObjectui64vEXT(mQueries[mCurrent][s], GL_QUERY_RESULT_EXT, &elapsedNs);
+                out.ms[s] = (float)(elapsedNs / 1000000.0);
+            }
+            resolved = true;
+        }
+        else
+        {
+            mDropped++;
+        }
+    }
+
+    slot.frameIndex = frameIndex;
+    slot.pending = false;
+    memset(slot.used, 0, sizeof(slot.used));
+    return resolved;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void GpuTimer::Begin(uint32_t scope)
+{
+    if (!mAvailable || scope >= MaxScopes)
+        return;
+    s_glBeginQueryEXT(GL_TIME_ELAPSED_EXT, mQueries[mCurrent][scope]);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void GpuTimer::End(uint32_t scope)
+{
+    if (!mAvailable || scope >= MaxScopes)
+        return;
+    s_glEndQueryEXT(GL_TIME_ELAPSED_EXT);
+    mSlots[mCurrent].used[scope] = true;
+    mSlots[mCurrent].pending = true;
+}
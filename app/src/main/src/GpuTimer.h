@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_GPUTIMER_H
+#define CLIENT_APP_OVR_GPUTIMER_H
+
+#include <stdint.h>
+#include <GLES3/gl3.h>
+
+// GPU time of a few scopes per frame, from GL_EXT_disjoint_timer_query.
+// Queries for a frame are read back Latency frames later, once the GPU is
+// surely done with them, so timing never stalls the pipeline.  A frame whose
+// results aren't in by then, or that saw a disjoint event (clock change,
+// power collapse), is dropped rather than reported wrong.  Render thread
+// only, with its context current.
+class GpuTimer
+{
+public:
+    static constexpr uint32_t Latency = 4;
+    static constexpr uint32_t MaxScopes = 2; // one per eye.
+
+    struct Result
+    {
+        uint64_t frameIndex;
+        float ms[MaxScopes];    // < 0 for a scope not timed that frame.
+    };
+
+    // false, and every call after a no-op, if the extension isn't there.
+    bool Initialize();
+    void Release();
+    bool IsAvailable() const { return mAvailable; }
+
+    // starts timing frameIndex.  true if an older frame's results came back in out.
+    bool BeginFrame(uint64_t frameIndex, Result& out);
+    // scopes can't nest, the extension allows one elapsed-time query at a time.
+    void Begin(uint32_t scope);
+    void End(uint32_t scope);
+
+    uint32_t DroppedFrames() const { return mDropped; }
+
+private:
+    struct Slot
+    {
+        uint64_t frameIndex;
+        bool pending;
+        bool used[MaxScopes];
+    };
+
+    bool mAvailable = false;
+    GLuint mQueries[Latency][MaxScopes] = {};
+    Slot mSlots[Latency] = {};
+    uint32_t mCurrent = 0;
+    uint32_t mDropped = 0;
+};
+
+#endif //CLIENT_APP_OVR_GPUTIMER_H
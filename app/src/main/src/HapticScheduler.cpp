@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "HapticScheduler.h"
+#define LOG_TAG "HapticScheduler"
+#include "CloudXRLog.h"
+
+#include <math.h>
+#include <time.h>
+#include <sys/prctl.h>
+#include <chrono>
+
+// same clock as vrapi display times.
+static double NowS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 0.000000001;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void HapticScheduler::Start(ovrMobile* session, const ControllerRegistry* controllers)
+{
+    if (mThread.joinable())
+        return;
+
+    mSession = session;
+    mControllers = controllers;
+    for (Hand& hand : mHands)
+    {
+        hand.numPulses = 0;
+        hand.submittedEndS = 0;
+    }
+    mRunning = true;
+    mThread = std::thread([this]() { WorkerLoop(); });
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void HapticScheduler::Stop()
+{
+    if (!mThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRunning = false;
+    }
+    mWake.notify_all();
+    mThread.join();
+
+    if (mDroppedPulses)
+        CXR_LOGW("Dropped %u haptic pulses, queue was full.", mDroppedPulses);
+    mDroppedPulses = 0;
+    mSession = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void HapticScheduler::Enqueue(uint32_t handIndex, double startS, float seconds, float frequency, float amplitude)
+{
+    if (handIndex >= ControllerRegistry::MaxHands || seconds <= 0 || amplitude <= 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mRunning)
+            return;
+
+        Hand& hand = mHands[handIndex];
+        if (hand.numPulses == MaxPulses)
+        {
+            // drop the oldest, the newest is what the app is asking for now.
+            for (uint32_t i = 1; i < MaxPulses; ++i)
+                hand.pulses[i - 1] = hand.pulses[i];
+            hand.numPulses--;
+            mDroppedPulses++;
+        }
+
+        Pulse& p = hand.pulses[hand.numPulses++];
+        p.startS = startS;
+        p.endS = startS + seconds;
+        p.frequency = frequency;
+        p.amplitude = amplitude > 1.0f ? 1.0f : amplitude;
+    }
+    mWake.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void HapticScheduler::WorkerLoop()
+{
+    prctl(PR_SET_NAME, (long)"CXR Haptics", 0, 0, 0);
+
+    Pulse pulses[MaxPulses];
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mRunning)
+    {
+        const double nowS = NowS();
+        double wakeS = nowS + 1.0; // idle
+
+        ControllerRegistry::Snapshot controllers;
+        mControllers->Get(controllers);
+
+        for (uint32_t handIndex = 0; handIndex < ControllerRegistry::MaxHands; ++handIndex)
+        {
+            Hand& hand = mHands[handIndex];
+            if (hand.submittedEndS < nowS)
+                hand.submittedEndS = 0; // whatever we sent has played out.
+
+            // retire pulses that are entirely covered by what's already submitted.
+            const double playedS = (hand.submittedEndS > nowS) ? hand.submittedEndS : nowS;
+            uint32_t kept = 0;
+            double firstStartS = 0;
+            for (uint32_t i = 0; i < hand.numPulses; ++i)
+            {
+                if (hand.pulses[i].endS <= playedS)
+                    continue;
+                if (!kept || hand.pulses[i].startS < firstStartS)
+                    firstStartS = hand.pulses[i].startS;
+                hand.pulses[kept++] = hand.pulses[i];
+            }
+            hand.numPulses = kept;
+            if (!kept)
+                continue;
+
+            const ControllerRegistry::Controller& ctl = controllers.hands[handIndex];
+            if (!ctl.present || !ctl.hapticSamplesMax)
+            {
+                hand.numPulses = 0; // nothing to play them on.
+                continue;
+            }
+
+            // carry on from the end of the last buffer, or start fresh at the first pulse.
+            double startS = hand.submittedEndS ? hand.submittedEndS : nowS;
+            if (firstStartS > startS)
+                startS = firstStartS;
+            if (startS - SubmitLeadS > nowS)
+            {
+                if (startS - SubmitLeadS < wakeS)
+                    wakeS = startS - SubmitLeadS;
+                continue;
+            }
+
+            // copy out so the callback can keep queueing while we synthesize.
+            for (uint32_t i = 0; i < kept; ++i)
+                pulses[i] = hand.pulses[i];
+
+            lock.unlock();
+            const double endS = SubmitBuffer(hand, pulses, kept, ctl, startS);
+            lock.lock();
+
+            hand.submittedEndS = endS;
+            if (endS - SubmitLeadS < wakeS)
+                wakeS = endS - SubmitLeadS;
+        }
+
+        if (!mRunning)
+            break;
+        const double waitS = wakeS - NowS();
+        if (waitS > 0)
+            mWake.wait_for(lock, std::chrono::microseconds((int64_t)(waitS * 1000000.0)));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Mix every pulse active at each sample.  A pulse with a frequency the sample
+// rate can represent is gated on/off at that rate, otherwise it's a constant
+// level for its duration.
+//-----------------------------------------------------------------------------
+double HapticScheduler::SubmitBuffer(Hand& hand, const Pulse* pulses, uint32_t numPulses,
+                                     const ControllerRegistry::Controller& ctl, double startS)
+{
+    const double sampleS = (ctl.hapticSampleDurationMS ? ctl.hapticSampleDurationMS : 2) * 0.001;
+    uint32_t numSamples = ctl.hapticSamplesMax < MaxSamples ? ctl.hapticSamplesMax : MaxSamples;
+    const uint32_t spanSamples = (uint32_t)ceil(MaxBufferS / sampleS);
+    if (numSamples > spanSamples)
+        numSamples = spanSamples;
+
+    double lastEndS = 0;
+    for (uint32_t i = 0; i < numPulses; ++i)
+        if (pulses[i].endS > lastEndS)
+            lastEndS = pulses[i].endS;
+
+    uint32_t lastNonZero = 0;
+    for (uint32_t s = 0; s < numSamples; ++s)
+    {
+        const double t = startS + (s + 0.5) * sampleS;
+        float level = 0;
+        for (uint32_t i = 0; i < numPulses; ++i)
+        {
+            const Pulse& p = pulses[i];
+            if (t < p.startS || t >= p.endS)
+                continue;
+            if (p.frequency > 0 && p.frequency * 2.0 * sampleS <= 1.0)
+            {
+                const double period = 1.0 / p.frequency;
+                if (fmod(t - p.startS, period) >= period * 0.5)
+                    continue;
+            }
+            level += p.amplitude;
+        }
+        if (level > 1.0f)
+            level = 1.0f;
+        hand.samples[s] = static_cast<uint8_t>(level * 255.f);
+        if (hand.samples[s])
+            lastNonZero = s + 1;
+    }
+
+    // if every pulse ends within this buffer, trim the tail and let vrapi stop.
+    const double fullEndS = startS + numSamples * sampleS;
+    const bool terminated = lastEndS <= fullEndS;
+    if (terminated && lastNonZero)
+        numSamples = lastNonZero;
+
+    ovrHapticBuffer hapticBuffer;
+    hapticBuffer.BufferTime = startS;
+    hapticBuffer.NumSamples = numSamples;
+    hapticBuffer.HapticBuffer = hand.samples;
+    hapticBuffer.Terminated = terminated;
+    if (vrapi_SetHapticVibrationBuffer(mSession, ctl.deviceID, &hapticBuffer) < 0)
+        CXR_LOGW("vrapi_SetHapticVibrationBuffer failed for device %u", ctl.deviceID);
+
+    return startS + numSamples * sampleS;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_HAPTICSCHEDULER_H
+#define CLIENT_APP_OVR_HAPTICSCHEDULER_H
+
+#include <stdint.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "VrApi.h"
+#include "VrApi_Input.h"
+
+#include "ControllerRegistry.h"
+
+// Plays server haptic pulses on a worker thread.  The haptic callback only
+// queues the pulse; the worker mixes all overlapping pulses per controller
+// into preallocated sample buffers, gating each at its requested frequency
+// for its requested duration, and streams short buffers to vrapi just ahead
+// of when they should be felt.  Keeping buffers short means a pulse that
+// arrives mid-stream is mixed in within one buffer rather than cutting off
+// or waiting behind the one playing.
+class HapticScheduler
+{
+public:
+    static constexpr uint32_t MaxPulses = 16;       // per controller, oldest dropped when full.
+    static constexpr uint32_t MaxSamples = 256;     // per buffer.
+    static constexpr double MaxBufferS = 0.05;      // longest span one submitted buffer covers.
+    static constexpr double SubmitLeadS = 0.01;     // how far ahead of its start a buffer is handed to vrapi.
+
+    ~HapticScheduler() { Stop(); }
+
+    void Start(ovrMobile* session, const ControllerRegistry* controllers);
+    void Stop();
+
+    // any thread.  startS is on the vrapi clock, normally the next display time.
+    void Enqueue(uint32_t hand, double startS, float seconds, float frequency, float amplitude);
+
+    uint32_t GetDroppedPulses() const { return mDroppedPulses; }
+
+private:
+    struct Pulse
+    {
+        double startS;
+        double endS;
+        float frequency;
+        float amplitude;
+    };
+
+    struct Hand
+    {
+        Pulse pulses[MaxPulses];
+        uint32_t numPulses;
+        double submittedEndS;   // end of audio already handed to vrapi, 0 when idle.
+        uint8_t samples[MaxSamples];
+    };
+
+    void WorkerLoop();
+    // fills and submits the buffer starting at startS, returns the time it ends.
+    double SubmitBuffer(Hand& hand, const Pulse* pulses, uint32_t numPulses,
+                        const ControllerRegistry::Controller& ctl, double startS);
+
+    ovrMobile* mSession = nullptr;
+    const ControllerRegistry* mControllers = nullptr;
+
+    Hand mHands[ControllerRegistry::MaxHands] = {};
+
+    std::thread mThread;
+    std::mutex mMutex;  // guards pulse lists, samples are worker only.
+    std::condition_variable mWake;
+    bool mRunning = false;
+    uint32_t mDroppedPulses = 0;
+};
+
+#endif //CLIENT_APP_OVR_HAPTICSCHEDULER_H
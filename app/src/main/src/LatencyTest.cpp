@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LatencyTest.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+
+#define LOG_TAG "LatencyTest"
+#include "CloudXRLog.h"
+
+// poses go to the server and back as floats, allow for a little rounding.
+static const float PoseRotationTolerance = 1e-5f;  // 1 - |dot|
+static const float PosePositionTolerance = 1e-4f;  // meters
+
+//-----------------------------------------------------------------------------
+// 0.5ms buckets up to 500ms, past that is not a latency worth resolving.
+//-----------------------------------------------------------------------------
+LatencyTest::LatencyTest()
+    : mInputToSubmit(0, 0.5f, 1000), mInputToDisplay(0, 0.5f, 1000),
+      mPoseToLatch(0, 0.5f, 1000), mPoseToSubmit(0, 0.5f, 1000), mPoseToDisplay(0, 0.5f, 1000)
+{
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void LatencyTest::Reset()
+{
+    {
+        std::lock_guard<std::mutex> lock(mPoseMutex);
+        mPoseCount = 0;
+    }
+    mTakenSeq = mEdgeSeq.load(std::memory_order_acquire);
+    mInputToSubmit.Reset();
+    mInputToDisplay.Reset();
+    mPoseToLatch.Reset();
+    mPoseToSubmit.Reset();
+    mPoseToDisplay.Reset();
+    mPoseUnmatched = mPoseAmbiguous = 0;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void LatencyTest::InputPolled(bool pressed, double timeS)
+{
+    if (pressed == mPolledPressed)
+        return;
+    mPolledPressed = pressed;
+
+    mEdgeS.store(timeS, std::memory_order_relaxed);
+    mEdgePressed.store(pressed, std::memory_order_relaxed);
+    mEdgeSeq.fetch_add(1, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool LatencyTest::TakeInputEdge(bool& pressed, double& edgeS)
+{
+    const uint32_t seq = mEdgeSeq.load(std::memory_order_acquire);
+    if (seq == mTakenSeq)
+        return false;
+    mTakenSeq = seq;
+    pressed = mEdgePressed.load(std::memory_order_relaxed);
+    edgeS = mEdgeS.load(std::memory_order_relaxed);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void LatencyTest::PoseSent(const cxrTrackedDevicePose& pose, double timeS)
+{
+    std::lock_guard<std::mutex> lock(mPoseMutex);
+    PoseSample& sample = mPoses[mPoseCount % PoseHistory];
+    sample.timeS = timeS;
+    sample.rotation = pose.rotation;
+    sample.position = pose.position;
+    mPoseCount++;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+static bool PoseMatches(const cxrQuaternion& qa, const cxrVector3& pa, const cxrQuaternion& qb, const cxrVector3& pb)
+{
+    const float dot = fabsf(qa.w*qb.w + qa.x*qb.x + qa.y*qb.y + qa.z*qb.z);
+    if (1.0f - dot > PoseRotationTolerance)
+        return false;
+    return fabsf(pa.v[0] - pb.v[0]) <= PosePositionTolerance && fabsf(pa.v[1] - pb.v[1]) <= PosePositionTolerance &&
+           fabsf(pa.v[2] - pb.v[2]) <= PosePositionTolerance;
+}
+
+//-----------------------------------------------------------------------------
+// Newest first, a frame is almost always rendered from a recent sample.
+//-----------------------------------------------------------------------------
+double LatencyTest::FindPoseSample(const cxrQuaternion& rotation, const cxrVector3& position)
+{
+    std::lock_guard<std::mutex> lock(mPoseMutex);
+    const uint32_t history = (mPoseCount < PoseHistory) ? mPoseCount : PoseHistory;
+    for (uint32_t back = 0; back < history; back++)
+    {
+        const PoseSample& sample = mPoses[(mPoseCount - 1 - back) % PoseHistory];
+        if (!PoseMatches(rotation, position, sample.rotation, sample.position))
+            continue;
+
+        if (back + 1 < history)
+        {
+            const PoseSample& before = mPoses[(mPoseCount - 2 - back) % PoseHistory];
+            if (PoseMatches(rotation, position, before.rotation, before.position))
+            {
+                mPoseAmbiguous++;
+                return -1.0;
+            }
+        }
+        return sample.timeS;
+    }
+
+    mPoseUnmatched++;
+    return -1.0;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void LatencyTest::AddInputFrame(double inputS, double submitS, double displayS)
+{
+    mInputToSubmit.Add((float)((submitS - inputS) * 1000.0));
+    mInputToDisplay.Add((float)((displayS - inputS) * 1000.0));
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void LatencyTest::AddPoseFrame(double sampleS, double latchS, double submitS, double displayS)
+{
+    mPoseToLatch.Add((float)((latchS - sampleS) * 1000.0));
+    mPoseToSubmit.Add((float)((submitS - sampleS) * 1000.0));
+    mPoseToDisplay.Add((float)((displayS - sampleS) * 1000.0));
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+static void LogHistogram(const char* name, const cxrStatsHistogram& h)
+{
+    if (h.Count() == 0)
+        return;
+    CXR_LOGI("Latency %s (ms): n %u, min %.1f, p50 %.1f, p90 %.1f, p99 %.1f, max %.1f, mean %.1f", name, h.Count(),
+             h.Min(), h.Percentile(50), h.Percentile(90), h.Percentile(99), h.Max(), h.Mean());
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void LatencyTest::LogSummary() const
+{
+    LogHistogram("input to submit", mInputToSubmit);
+    LogHistogram("input to display", mInputToDisplay);
+    LogHistogram("pose to latch", mPoseToLatch);
+    LogHistogram("pose to submit", mPoseToSubmit);
+    LogHistogram("pose to display", mPoseToDisplay);
+    if (mPoseUnmatched || mPoseAmbiguous)
+        CXR_LOGI("Latency: %u frames not matched to a sent pose, %u skipped as ambiguous.", mPoseUnmatched,
+                 mPoseAmbiguous);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+static void WriteHistogram(FILE* file, const char* name, const cxrStatsHistogram& h)
+{
+    fprintf(file, "%s,%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", name, h.Count(), h.Min(), h.Percentile(50),
+            h.Percentile(90), h.Percentile(99), h.Max(), h.Mean());
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool LatencyTest::Write(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        CXR_LOGE("Err #%s opening latency report: %s", strerror(errno), path.c_str());
+        return false;
+    }
+
+    fprintf(file, "measure,count,min_ms,p50_ms,p90_ms,p99_ms,max_ms,mean_ms\n");
+    WriteHistogram(file, "input_to_submit", mInputToSubmit);
+    WriteHistogram(file, "input_to_display", mInputToDisplay);
+    WriteHistogram(file, "pose_to_latch", mPoseToLatch);
+    WriteHistogram(file, "pose_to_submit", mPoseToSubmit);
+    WriteHistogram(file, "pose_to_display", mPoseToDisplay);
+    fprintf(file, "pose_unmatched,%u\npose_ambiguous,%u\n", mPoseUnmatched, mPoseAmbiguous);
+
+    fclose(file);
+    CXR_LOGI("Wrote latency report to %s", path.c_str());
+    return true;
+}
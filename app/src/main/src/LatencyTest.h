@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_LATENCYTEST_H
+#define CLIENT_APP_OVR_LATENCYTEST_H
+
+#include <stdint.h>
+#include <string>
+#include <mutex>
+#include <atomic>
+
+#include "CloudXRClient.h"
+#include "CloudXRStatsAggregator.h"
+
+// Measurements for -latency-test.  All times on the GetTimeInSeconds() clock.
+//
+// Local, with no server: the tracking sampler polls the buttons, and the render
+// thread flips the background on each press or release.  Each flip is timed
+// from the poll that saw the edge, to submit, and to the display time it was
+// submitted for, which is when it should reach the panel.  A photodiode or
+// camera on the lens checks the last step independently.
+//
+// Connected: every pose sent is remembered, and each latched frame's pose is
+// matched back to the sample it was rendered from, which times motion to
+// latch, submit and display through the whole stream.  The head has to be
+// moving, a pose that matches more than one consecutive sample is skipped.
+class LatencyTest
+{
+public:
+    static constexpr uint32_t PoseHistory = 512; // ~0.5s at 1khz, several seconds inline.
+
+    LatencyTest();
+    void Reset();
+
+    // tracking side, from whichever one thread polls.
+    void InputPolled(bool pressed, double timeS);
+    void PoseSent(const cxrTrackedDevicePose& pose, double timeS);
+
+    // render thread.  true once per edge, with the state it went to.
+    bool TakeInputEdge(bool& pressed, double& edgeS);
+    // sample time of the pose a frame was rendered with, < 0 if not found or ambiguous.
+    double FindPoseSample(const cxrQuaternion& rotation, const cxrVector3& position);
+    void AddInputFrame(double inputS, double submitS, double displayS);
+    void AddPoseFrame(double sampleS, double latchS, double submitS, double displayS);
+
+    uint32_t Samples() const { return mInputToDisplay.Count() + mPoseToDisplay.Count(); }
+    void LogSummary() const;
+    bool Write(const std::string& path) const;
+
+private:
+    // edge from the tracking side, picked up by the render thread.  two edges
+    // between frames would show as one flip anyway.
+    bool mPolledPressed = false;
+    std::atomic<uint32_t> mEdgeSeq{0};
+    std::atomic<double> mEdgeS{0};
+    std::atomic<bool> mEdgePressed{false};
+    uint32_t mTakenSeq = 0;
+
+    struct PoseSample
+    {
+        double timeS;
+        cxrQuaternion rotation;
+        cxrVector3 position;
+    };
+    std::mutex mPoseMutex;
+    PoseSample mPoses[PoseHistory];
+    uint32_t mPoseCount = 0; // total sent, next slot is mPoseCount % PoseHistory.
+
+    cxrStatsHistogram mInputToSubmit;
+    cxrStatsHistogram mInputToDisplay;
+    cxrStatsHistogram mPoseToLatch;
+    cxrStatsHistogram mPoseToSubmit;
+    cxrStatsHistogram mPoseToDisplay;
+    uint32_t mPoseUnmatched = 0;
+    uint32_t mPoseAmbiguous = 0;
+};
+
+#endif //CLIENT_APP_OVR_LATENCYTEST_H
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "StartupTimeline.h"
+#define LOG_TAG "Startup"
+#include "CloudXRLog.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------
+// Process start is field 22 of /proc/self/stat, in clock ticks since boot.
+// The command name in field 2 can hold spaces, so count from its closing paren.
+//-----------------------------------------------------------------------------
+static double ReadProcessStartS()
+{
+    FILE* f = fopen("/proc/self/stat", "r");
+    if (!f)
+        return 0;
+    char buf[1024] = "";
+    const size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = 0;
+
+    const char* p = strrchr(buf, ')');
+    if (!p)
+        return 0;
+    unsigned long long startTicks = 0;
+    // after the paren come fields 3 onwards, starttime is the 20th of those.
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+               &startTicks) != 1)
+        return 0;
+    return (double)startTicks / (double)sysconf(_SC_CLK_TCK);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+StartupTimeline::StartupTimeline()
+{
+    for (auto& t : mTimes)
+        t.store(0, std::memory_order_relaxed);
+    mTimes[Phase_ProcessStart].store(ReadProcessStartS(), std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+double StartupTimeline::NowS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    return now.tv_sec + now.tv_nsec * 0.000000001;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void StartupTimeline::Mark(Phase phase)
+{
+    double expected = 0;
+    mTimes[phase].compare_exchange_strong(expected, NowS(), std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void StartupTimeline::Rearm()
+{
+    if (!mReported)
+        return;
+    for (uint32_t i = Phase_VrModeEntered; i < Phase_Count; ++i)
+        mTimes[i].store(0, std::memory_order_relaxed);
+    mResume = true;
+    mResumeIndex++;
+    mReported = false;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+bool StartupTimeline::TakeReport()
+{
+    if (mTimes[Phase_FirstFrameSubmitted].load(std::memory_order_relaxed) == 0)
+        return false;
+    return !mReported.exchange(true);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+const char* StartupTimeline::PhaseName(Phase phase)
+{
+    static const char* names[Phase_Count] = {
+        "process start", "native main", "options parsed", "vr mode entered", "device desc ready",
+        "server selected", "swapchains ready", "audio open started", "receiver created", "connect started",
+        "audio ready", "connected", "first frame latched", "first frame submitted",
+    };
+    return names[phase];
+}
+
+//-----------------------------------------------------------------------------
+// One line per phase in the order they happened: time from the start, and the
+// gap since the phase before it, so the slow step stands out.
+//-----------------------------------------------------------------------------
+void StartupTimeline::Write(const std::string& path) const
+{
+    double times[Phase_Count];
+    for (uint32_t i = 0; i < Phase_Count; ++i)
+        times[i] = mTimes[i].load(std::memory_order_relaxed);
+
+    const uint32_t first = mResume ? Phase_VrModeEntered : (times[Phase_ProcessStart] > 0 ? Phase_ProcessStart : Phase_NativeMain);
+    const double startS = times[first];
+
+    // phases can finish out of enum order when they overlap, so sort by time.
+    uint32_t order[Phase_Count];
+    uint32_t count = 0;
+    for (uint32_t i = first; i < Phase_Count; ++i)
+    {
+        if (times[i] <= 0)
+            continue;
+        uint32_t j = count++;
+        while (j > 0 && times[order[j - 1]] > times[i])
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    FILE* f = path.empty() ? nullptr : fopen(path.c_str(), "w");
+    const double totalMs = (times[Phase_FirstFrameSubmitted] - startS) * 1000.0;
+    CXR_LOGI("%s report: first frame on screen %.1f ms after %s.", mResume ? "Resume" : "Startup", totalMs,
+             PhaseName((Phase)first));
+    if (f)
+        fprintf(f, "%s, first frame %.1f ms after %s\n", mResume ? "resume" : "startup", totalMs, PhaseName((Phase)first));
+
+    double prevS = startS;
+    for (uint32_t k = 0; k < count; ++k)
+    {
+        const double t = times[order[k]];
+        CXR_LOGI("  %8.1f ms  (+%7.1f)  %s", (t - startS) * 1000.0, (t - prevS) * 1000.0, PhaseName((Phase)order[k]));
+        if (f)
+            fprintf(f, "%.1f,%.1f,%s\n", (t - startS) * 1000.0, (t - prevS) * 1000.0, PhaseName((Phase)order[k]));
+        prevS = t;
+    }
+
+    if (f)
+        fclose(f);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_STARTUPTIMELINE_H
+#define CLIENT_APP_OVR_STARTUPTIMELINE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+// Timestamps for each stage from process start to the first streamed frame on
+// screen.  Mark is lock-free and keeps the first time a phase is hit, so it can
+// be dropped into any thread's path without caring who gets there first.  Once
+// the first frame is out, the owner writes the whole thing as one report.
+class StartupTimeline
+{
+public:
+    enum Phase
+    {
+        Phase_ProcessStart = 0,     // from /proc, before any of our code ran.
+        Phase_NativeMain,
+        Phase_OptionsParsed,        // launch options read, logger up.
+        Phase_VrModeEntered,
+        Phase_DeviceDescReady,      // system properties, refresh rate, chaperone.
+        Phase_ServerSelected,       // candidate servers probed, only with several.
+        Phase_SwapchainsReady,
+        Phase_AudioOpenStarted,
+        Phase_ReceiverCreated,
+        Phase_ConnectStarted,
+        Phase_AudioReady,
+        Phase_Connected,            // streaming session in progress.
+        Phase_FirstFrameLatched,
+        Phase_FirstFrameSubmitted,
+        Phase_Count
+    };
+
+    StartupTimeline();
+
+    void Mark(Phase phase);
+
+    // re-arm before entering vr mode for a cold resume, which runs everything
+    // from there on again.  the process-level phases are left out of its report.
+    // does nothing until the first report is out, so one startup isn't split in two.
+    void Rearm();
+
+    // true once, when the first frame has been submitted and it hasn't been written yet.
+    bool TakeReport();
+
+    // logs the report, and writes it to path if given.
+    void Write(const std::string& path) const;
+
+    // 0 for the startup report, n for the nth resume since.
+    uint32_t ResumeIndex() const { return mResumeIndex; }
+
+    static const char* PhaseName(Phase phase);
+
+private:
+    static double NowS(); // CLOCK_BOOTTIME, the clock process start time is on.
+
+    std::atomic<double> mTimes[Phase_Count];
+    std::atomic<bool> mReported{false};
+    bool mResume = false;
+    uint32_t mResumeIndex = 0;
+};
+
+#endif //CLIENT_APP_OVR_STARTUPTIMELINE_H
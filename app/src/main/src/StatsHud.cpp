@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "StatsHud.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include <GLES3/gl3.h>
+
+#define LOG_TAG "StatsHud"
+#include "CloudXRLog.h"
+
+// classic 5x7 font, printable ascii from ' ', one byte per column, bit 0 at the top.
+static const uint8_t s_font5x7[][5] =
+{
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x01,0x01}, {0x3E,0x41,0x41,0x51,0x32},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x04,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x7F,0x20,0x18,0x20,0x7F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x08,0x14,0x54,0x54,0x3C},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x00,0x7F,0x10,0x28,0x44},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x10,0x08,0x08,0x10,0x08},
+};
+
+// RGBA8 in memory order, so 0xAABBGGRR.
+static const uint32_t HudBackground = 0xA0000000;
+static const uint32_t HudText = 0xFFE0E0E0;
+
+//-----------------------------------------------------------------------------
+// The panel is a slice of a 1m cylinder around the head, a little below eye
+// level, and fixed to the view so it doesn't need a pose every frame.  The
+// texture matrix maps the whole image onto the slice; density sets how many
+// pixels wrap the full circle, and so how big the text looks.
+//-----------------------------------------------------------------------------
+bool StatsHud::Initialize()
+{
+    if (mSwapChain)
+        return true;
+
+    mSwapChain = vrapi_CreateTextureSwapChain2(VRAPI_TEXTURE_TYPE_2D, VRAPI_TEXTURE_FORMAT_8888, Width, Height, 1, 3);
+    if (!mSwapChain)
+    {
+        CXR_LOGE("Unable to create stats hud swapchain.");
+        return false;
+    }
+    mSwapChainLength = vrapi_GetTextureSwapChainLength(mSwapChain);
+    mSwapChainIndex = 0;
+    for (int i = 0; i < mSwapChainLength; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, vrapi_GetTextureSwapChainHandle(mSwapChain, i));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    mPixels.assign(Width * Height, HudBackground);
+
+    const float density = 4096.0f;
+    const float radius = 1.0f;
+    const float pitch = -0.30f; // radians, looking down a bit to read it.
+    const ovrMatrix4f scale = ovrMatrix4f_CreateScale(radius, radius * (float)Height * VRAPI_PI / density, radius);
+    const ovrMatrix4f rotation = ovrMatrix4f_CreateRotation(pitch, 0.0f, 0.0f);
+    const ovrMatrix4f cylinder = ovrMatrix4f_Multiply(&rotation, &scale);
+    const ovrMatrix4f texCoordsFromTanAngles = ovrMatrix4f_Inverse(&cylinder);
+
+    const float circScale = density * 0.5f / Width;
+    const float circBias = -circScale * (0.5f * (1.0f - 1.0f / circScale));
+    const float texScaleY = -0.5f;
+    const float texBiasY = texScaleY * (0.5f * (1.0f - 1.0f / texScaleY));
+
+    mLayer = vrapi_DefaultLayerCylinder2();
+    mLayer.Header.Flags |= VRAPI_FRAME_LAYER_FLAG_FIXED_TO_VIEW | VRAPI_FRAME_LAYER_FLAG_INHIBIT_SRGB_FRAMEBUFFER;
+    mLayer.Header.SrcBlend = VRAPI_FRAME_LAYER_BLEND_SRC_ALPHA;
+    mLayer.Header.DstBlend = VRAPI_FRAME_LAYER_BLEND_ONE_MINUS_SRC_ALPHA;
+    for (int eye = 0; eye < VRAPI_FRAME_LAYER_EYE_MAX; eye++)
+    {
+        mLayer.Textures[eye].ColorSwapChain = mSwapChain;
+        mLayer.Textures[eye].SwapChainIndex = mSwapChainIndex;
+        mLayer.Textures[eye].TexCoordsFromTanAngles = texCoordsFromTanAngles;
+        mLayer.Textures[eye].TextureRect = { 0.0f, 0.0f, 1.0f, 1.0f };
+        mLayer.Textures[eye].TextureMatrix.M[0][0] = circScale;
+        mLayer.Textures[eye].TextureMatrix.M[0][2] = circBias;
+        mLayer.Textures[eye].TextureMatrix.M[1][1] = texScaleY;
+        mLayer.Textures[eye].TextureMatrix.M[1][2] = -texBiasY;
+    }
+
+    mHasImage = false;
+    mNextUpdateS = 0;
+    CXR_LOGI("Stats hud created, %u x %u.", Width, Height);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void StatsHud::Release()
+{
+    if (mSwapChain)
+        vrapi_DestroyTextureSwapChain(mSwapChain);
+    mSwapChain = nullptr;
+    mHasImage = false;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void StatsHud::DrawText(uint32_t x, uint32_t y, const char* text, uint32_t color)
+{
+    for (uint32_t c = 0; text[c] && c < LineChars; c++, x += 6 * GlyphScale)
+    {
+        const uint8_t ch = (uint8_t)text[c];
+        if (ch <= ' ' || ch > '~')
+            continue;
+        const uint8_t* glyph = s_font5x7[ch - ' '];
+        for (uint32_t col = 0; col < 5; col++)
+        {
+            for (uint32_t row = 0; row < 7; row++)
+            {
+                if (!(glyph[col] & (1 << row)))
+                    continue;
+                for (uint32_t sy = 0; sy < GlyphScale; sy++)
+                {
+                    uint32_t* dst = &mPixels[(y + row * GlyphScale + sy) * Width + x + col * GlyphScale];
+                    for (uint32_t sx = 0; sx < GlyphScale; sx++)
+                        dst[sx] = color;
+                }
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// The image goes into the next swapchain image, so the compositor can keep
+// reading the one it has until this frame's layer points it at the new one.
+//-----------------------------------------------------------------------------
+void StatsHud::Update(const char* const lines[], uint32_t lineCount, double nowS)
+{
+    if (!mSwapChain)
+        return;
+    mNextUpdateS = nowS + UpdateIntervalS;
+
+    std::fill(mPixels.begin(), mPixels.end(), HudBackground);
+    const uint32_t margin = GlyphScale * 2;
+    for (uint32_t i = 0; i < lineCount && i < MaxLines; i++)
+        DrawText(margin, margin + i * 9 * GlyphScale, lines[i], HudText);
+
+    mSwapChainIndex = (mSwapChainIndex + 1) % mSwapChainLength;
+    glBindTexture(GL_TEXTURE_2D, vrapi_GetTextureSwapChainHandle(mSwapChain, mSwapChainIndex));
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Width, Height, GL_RGBA, GL_UNSIGNED_BYTE, mPixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    for (int eye = 0; eye < VRAPI_FRAME_LAYER_EYE_MAX; eye++)
+        mLayer.Textures[eye].SwapChainIndex = mSwapChainIndex;
+    mHasImage = true;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void StatsHud::AddLatencySample(float ms)
+{
+    mLatency[mLatencyCount % LatencyHistory] = ms;
+    mLatencyCount++;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+float StatsHud::LatencyPercentile(float pct) const
+{
+    const uint32_t count = std::min(mLatencyCount, LatencyHistory);
+    if (count == 0)
+        return 0.0f;
+
+    float sorted[LatencyHistory];
+    memcpy(sorted, mLatency, count * sizeof(float));
+    std::sort(sorted, sorted + count);
+    const uint32_t index = std::min(count - 1, (uint32_t)(pct / 100.0f * count));
+    return sorted[index];
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_STATSHUD_H
+#define CLIENT_APP_OVR_STATSHUD_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "VrApi.h"
+#include "VrApi_Helpers.h"
+
+// Head-locked text panel for on-headset diagnostics.  Text is drawn on the CPU
+// into a small image and uploaded into the HUD's own swapchain only when it
+// changes, around once a second, and the compositor draws it as a cylinder
+// layer over the world layer.  Nothing is added to the per-eye blits, a frame
+// without an update only costs the layer in the submit.
+// Only used from the thread that owns rendering, with its context current.
+class StatsHud
+{
+public:
+    static constexpr uint32_t Width = 512;
+    static constexpr uint32_t Height = 176;
+    static constexpr uint32_t GlyphScale = 2;   // 5x7 glyphs in 6x9 cells, doubled.
+    static constexpr uint32_t MaxLines = Height / (9 * GlyphScale);
+    static constexpr uint32_t LineChars = Width / (6 * GlyphScale);
+    static constexpr double UpdateIntervalS = 1.0;
+
+    bool Initialize();
+    void Release();
+    bool IsReady() const { return mSwapChain != nullptr; }
+
+    bool UpdateDue(double nowS) const { return mSwapChain && nowS >= mNextUpdateS; }
+    // draws and uploads a new image.  lines past MaxLines or LineChars are cut.
+    void Update(const char* const lines[], uint32_t lineCount, double nowS);
+
+    // null until there's an image to show.
+    const ovrLayerHeader2* Layer() const { return mHasImage ? &mLayer.Header : nullptr; }
+
+    // round trip samples, one per update, for the percentiles shown.
+    static constexpr uint32_t LatencyHistory = 60;
+    void AddLatencySample(float ms);
+    float LatencyPercentile(float pct) const; // pct in [0-100], 0 when empty.
+
+private:
+    void DrawText(uint32_t x, uint32_t y, const char* text, uint32_t color);
+
+    ovrTextureSwapChain* mSwapChain = nullptr;
+    int mSwapChainLength = 0;
+    int mSwapChainIndex = 0;
+    ovrLayerCylinder2 mLayer = {};
+    bool mHasImage = false;
+    double mNextUpdateS = 0;
+    std::vector<uint32_t> mPixels;
+
+    float mLatency[LatencyHistory] = {};
+    uint32_t mLatencyCount = 0;
+};
+
+#endif //CLIENT_APP_OVR_STATSHUD_H
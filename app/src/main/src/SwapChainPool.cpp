@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SwapChainPool.h"
+#define LOG_TAG "SwapChainPool"
+#include "CloudXRLog.h"
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void SwapChainPool::SetAllocationSize(uint32_t width, uint32_t height)
+{
+    mAllocWidth = width;
+    mAllocHeight = height;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+const SwapChainPool::Entry* SwapChainPool::Acquire(uint32_t width, uint32_t height)
+{
+    // smallest chain that holds the frame, to keep sampling and bandwidth down.
+    Entry* best = nullptr;
+    for (uint32_t i = 0; i < mNumEntries; ++i)
+    {
+        Entry& e = mEntries[i];
+        if (e.width < width || e.height < height)
+            continue;
+        if (!best || (uint64_t)e.width * e.height < (uint64_t)best->width * best->height)
+            best = &e;
+    }
+
+    if (!best)
+    {
+        // nothing fits, so the frame is bigger than anything we expected.  allocate
+        // at least the negotiated max size, evicting the least recently used if full.
+        const uint32_t allocW = (width > mAllocWidth) ? width : mAllocWidth;
+        const uint32_t allocH = (height > mAllocHeight) ? height : mAllocHeight;
+
+        if (mNumEntries < MaxEntries)
+        {
+            best = &mEntries[mNumEntries++];
+        }
+        else
+        {
+            best = &mEntries[0];
+            for (uint32_t i = 1; i < mNumEntries; ++i)
+            {
+                if (mEntries[i].lastUsed < best->lastUsed)
+                    best = &mEntries[i];
+            }
+            CXR_LOGW("Swapchain pool full, evicting %d x %d", best->width, best->height);
+            vrapi_DestroyTextureSwapChain(best->chain);
+        }
+
+        // Warning level, allocating mid-stream is expensive and should stand out in the log.
+        CXR_LOGW("Allocating swapchain %d x %d for %d x %d frames", allocW, allocH, width, height);
+
+        best->chain = vrapi_CreateTextureSwapChain2(mTextureType,
+                                                    VRAPI_TEXTURE_FORMAT_8888_sRGB,
+                                                    allocW, allocH,
+                                                    1, SwapChainLen);
+        if (!best->chain)
+        {
+            CXR_LOGE("Failed to create %d x %d swapchain", allocW, allocH);
+            *best = mEntries[--mNumEntries];
+            mEntries[mNumEntries] = {};
+            return nullptr;
+        }
+        best->width = allocW;
+        best->height = allocH;
+        best->length = vrapi_GetTextureSwapChainLength(best->chain);
+        mAllocations++;
+    }
+
+    best->lastUsed = ++mUseCounter;
+    return best;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void SwapChainPool::Release()
+{
+    for (uint32_t i = 0; i < mNumEntries; ++i)
+    {
+        if (mEntries[i].chain)
+            vrapi_DestroyTextureSwapChain(mEntries[i].chain);
+        mEntries[i] = {};
+    }
+    mNumEntries = 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLIENT_APP_OVR_SWAPCHAINPOOL_H
+#define CLIENT_APP_OVR_SWAPCHAINPOOL_H
+
+#include <stdint.h>
+
+#include "VrApi.h"
+
+// Keeps a few swapchains per eye, sized for the largest stream resolution we
+// negotiated, so server driven resolution changes just move the sub-rect we
+// render into instead of destroying and reallocating chains mid-stream.
+// Not thread-safe: the render thread uses it while running, and the main thread
+// only touches it (RecreateSwapchain on resume) with the render thread stopped.
+class SwapChainPool
+{
+public:
+    struct Entry
+    {
+        ovrTextureSwapChain* chain;
+        uint32_t width;     // allocated size
+        uint32_t height;
+        uint32_t length;
+        uint64_t lastUsed;
+    };
+
+    // chains get allocated at least this big, normally stream size * maxResFactor.
+    void SetAllocationSize(uint32_t width, uint32_t height);
+    // 2D for a chain per eye, 2D_ARRAY for one chain with a layer per eye.
+    // only takes effect for chains allocated after the call.
+    void SetTextureType(ovrTextureType type) { mTextureType = type; }
+
+    // returns the best fit chain for a frame of width x height, allocating only
+    // if nothing in the pool is big enough.  never returns null unless vrapi fails.
+    const Entry* Acquire(uint32_t width, uint32_t height);
+
+    void Release();
+
+    uint32_t GetAllocationCount() const { return mAllocations; }
+
+private:
+    static constexpr uint32_t MaxEntries = 3;
+    static constexpr uint32_t SwapChainLen = 3;
+
+    Entry mEntries[MaxEntries] = {};
+    uint32_t mNumEntries = 0;
+    uint32_t mAllocWidth = 0;
+    uint32_t mAllocHeight = 0;
+    ovrTextureType mTextureType = VRAPI_TEXTURE_TYPE_2D;
+    uint64_t mUseCounter = 0;
+    uint32_t mAllocations = 0; // lifetime count, for logging thrash.
+};
+
+#endif //CLIENT_APP_OVR_SWAPCHAINPOOL_H
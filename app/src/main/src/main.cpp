@@ -30,6 +30,8 @@
 #include <linux/prctl.h>
 #include <sys/prctl.h>
 #include <sys/system_properties.h>
+#include <sched.h>
+#include <time.h>
 
 #include "CloudXRClientOptions.h"
 #include "CloudXRMatrixHelpers.h"
@@ -38,6 +40,7 @@
 #include "CloudXRLog.h"
 
 #include "CloudXRFileLogger.h"
+#include "StartupTimeline.h"
 
 #include <string>
 #include <thread>
@@ -45,9 +48,11 @@
 #include <condition_variable>
 #include <map>
 #include <vector>
+#include <algorithm>
 
 static struct android_app* GAndroidApp = NULL;
 static CloudXR::ClientOptions GOptions;
+static StartupTimeline GStartup;
 static std::mutex GJniMutex;
 static CloudXRClientOVR *gClientHandle = NULL;
 
@@ -60,6 +65,8 @@ static const int GPU_LEVEL = 1;
 
 //-----------------------------------------------------------------------------
 cxrClientCallbacks CloudXRClientOVR::s_clientProxy = { 0 };
+cxrLogFilter g_logFilter;
+
 extern "C" void dispatchLogMsg(cxrLogLevel level, cxrMessageCategory category, void *extra, const char *tag, const char *fmt, ...)
 {
     va_list aptr;
@@ -77,6 +84,11 @@ extern "C" void dispatchLogMsg(cxrLogLevel level, cxrMessageCategory category, v
     va_end(aptr);
 }
 
+extern "C" void dispatchLogRecord(cxrLogLevel level, const void* record, uint32_t size)
+{
+    g_logFile.logRecord(level, record, size);
+}
+
 
 static double GetTimeInSeconds() {
     struct timespec now;
@@ -90,6 +102,29 @@ static uint64_t GetTimeInNS() {
     return ((uint64_t)(now.tv_sec * 1e9) + now.tv_nsec);
 }
 
+// logger settings that come from options, at launch and again from the control channel.
+static void ApplyLogLevelOptions()
+{
+    if (GOptions.mLogLevel >= 0)
+        g_logFile.setLogLevel((cxrLogLevel)GOptions.mLogLevel);
+    else if (GOptions.mDebugFlags & cxrDebugFlags_LogQuiet) // quiet takes precedence
+        g_logFile.setLogLevel(cxrLL_Silence);
+    else if (GOptions.mDebugFlags & cxrDebugFlags_LogVerbose)
+        g_logFile.setLogLevel(cxrLL_Verbose);
+    else
+        g_logFile.setLogLevel(cxrLL_Debug); // otherwise defaults to Info.
+
+    g_logFile.setPrivacyEnabled((GOptions.mDebugFlags & cxrDebugFlags_LogPrivacyDisabled) ? 0 : 1);
+}
+
+// the macros filter before dispatch, so the file logger's level also decides what
+// reaches logcat, as its own level check always did once it was initialized.
+static void ApplyLogFilterOptions()
+{
+    g_logFilter.minLevel = g_logFile.getLogLevel();
+    g_logFilter.categoryMask = GOptions.mLogCategoryMask;
+}
+
 #define CASE(x) \
 case x:     \
 return #x
@@ -326,12 +361,19 @@ cxrError CloudXRClientOVR::Initialize()
 //-----------------------------------------------------------------------------
 cxrError CloudXRClientOVR::Release()
 {
+    mControlChannel.Stop();
+
+    // exiting while warm suspended still holds the receiver and swapchains.
+    if (mWarmSuspended)
+        ReleaseStreamingResources();
+
     mEglHelper.Release();
 
     // if we somehow still have session, release it now so we don't block display.
     if (mOvrSession != NULL)
     {
         CXR_LOGI("CALLING vrapi_LeaveVrMode()");
+        mHaptics.Stop();
         vrapi_LeaveVrMode(mOvrSession);
         mOvrSession = NULL;
     }
@@ -354,6 +396,17 @@ void CloudXRClientOVR::RequestExit()
     CXR_LOGI("Requesting application exit.");
     mClientState = cxrClientState_Exiting;
     mRenderState = RenderState_Exiting;
+    WakeMainLoop();
+}
+
+//-----------------------------------------------------------------------------
+// The main loop sleeps in ALooper_pollAll, so anything that changes state from
+// another thread (server callbacks, render thread) needs to kick it awake.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::WakeMainLoop()
+{
+    if (mAndroidApp && mAndroidApp->looper)
+        ALooper_wake(mAndroidApp->looper);
 }
 
 //-----------------------------------------------------------------------------
@@ -382,7 +435,6 @@ void CloudXRClientOVR::UpdateClientState()
 
             case cxrClientState_ConnectionAttemptFailed:
             case cxrClientState_Disconnected:
-                CXR_LOGE("Exiting due to connection failure.");
                 // fall through to below common handling...
                 break;
 
@@ -395,7 +447,20 @@ void CloudXRClientOVR::UpdateClientState()
     if (mClientState==cxrClientState_Disconnected ||
         mClientState==cxrClientState_ConnectionAttemptFailed)
     {
-        RequestExit();
+        if (FailoverToNextServer())
+            return;
+
+        if (mWarmSuspended)
+        {
+            // nobody's in the headset to see it, so the resume just connects afresh.
+            CXR_LOGW("Server lost while warm suspended, resume will reconnect.");
+            ReleaseStreamingResources();
+        }
+        else
+        {
+            CXR_LOGE("Exiting due to connection failure.");
+            RequestExit();
+        }
     }
 }
 
@@ -407,46 +472,153 @@ cxrError CloudXRClientOVR::MainLoop()
 {
     const double startTime = GetTimeInSeconds();
 
+    // This thread only handles lifecycle and events, rendering happens on the
+    // render thread.  So we sleep until the looper has something for us, we're
+    // woken by WakeMainLoop, or it is time to poll the VrApi event queue again.
+    const int vrEventPollMs = 50;
+
     while (mAndroidApp->destroyRequested == 0 && mClientState != cxrClientState_Exiting) {
         // Read all pending events.
+        int timeoutMilliseconds = (mOvrSession == NULL || !mIsFocused) ? 250 : vrEventPollMs;
         for (;;) {
             int events;
             struct android_poll_source* source;
-            const int timeoutMilliseconds = (mOvrSession == NULL || !mIsFocused) ? 250 : 1;
             if (ALooper_pollAll(timeoutMilliseconds, NULL, &events, (void**)&source) < 0)
-                break;
+                break; // timed out or woken.
 
             // Process this event.
             if (source != NULL)
                 source->process(mAndroidApp, source);
 
+            // drain anything else already queued without blocking again.
+            timeoutMilliseconds = 0;
         }
 
         // check and update client state changes from callback
         UpdateClientState();
 
+        // before vr mode changes, so a resume can connect right away if it's settled.
+        UpdateServerSelection();
+
+        UpdateControlChannel();
+
         // we check state and handle vr enter/leave changes
         HandleVrModeChanges();
 
         // We must read from the event queue with regular frequency.
         HandleVrApiEvents();
 
-        // if not yet entered vr mode, just continue as not yet set up to render...
-        if (mOvrSession == NULL) continue;
+        UpdateQualityGovernor();
+        UpdateClockGovernor();
+        UpdateWarmSuspend();
+
+        if (GStartup.TakeReport())
+        {
+            // each resume gets its own file, rather than overwriting the startup's.
+            std::string name = "StartupReport " + g_logFile.getLogSuffix();
+            if (GStartup.ResumeIndex() > 0)
+                name += " resume " + std::to_string(GStartup.ResumeIndex());
+            GStartup.Write(mAppOutputPath + name + ".txt");
+        }
 
         // TODO: is this check now implicitly handled in client state changes?
         //if (Receiver && !cxrIsRunning(Receiver) && mRenderState != RenderState_Exiting)
         //    mRenderState = RenderState_Exiting;
+    }
+
+    // render thread must be done with the session before Release leaves vr mode.
+    StopRenderThread();
+
+    return cxrError_Success;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::StartRenderThread()
+{
+    if (mRenderThreadRunning || mOvrSession == NULL)
+        return;
+
+    mRenderThreadRunning = true;
+    mRenderThread = std::thread([this]() { RenderThreadLoop(); });
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::StopRenderThread()
+{
+    if (!mRenderThread.joinable())
+        return;
+
+    mRenderThreadRunning = false;
+    mRenderThread.join();
+}
+
+//-----------------------------------------------------------------------------
+// Owns its own EGL context for the life of a vr mode session: all FBOs, blits
+// and frame submission happen here.  Pacing comes from vrapi_SubmitFrame2.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::RenderThreadLoop()
+{
+    prctl(PR_SET_NAME, (long)"CXR Render", 0, 0, 0);
 
+    if (!mRenderEglHelper.InitializeShared(mEglHelper))
+    {
+        CXR_LOGE("Render thread failed to create its EGL context, exiting...");
+        mRenderThreadRunning = false;
+        RequestExit();
+        return;
+    }
+
+    vrapi_SetPerfThread(mOvrSession, VRAPI_PERF_THREAD_TYPE_RENDERER, gettid());
+    CXR_LOGI("		vrapi_SetPerfThread( RENDERER, %d )", gettid());
+
+    mGpuTimer.Initialize();
+
+    bool exitSubmitted = false;
+    while (mRenderThreadRunning && !exitSubmitted)
+    {
         if (mRenderState == RenderState_Loading)
             RenderLoadScreen();
         else if (mRenderState == RenderState_Exiting)
+        {
             RenderExitScreen();
+            exitSubmitted = true; // nothing more to submit after the FINAL frame.
+        }
         else
             Render();
     }
 
-    return cxrError_Success;
+    // we may have been stopped before the exit state made it here.
+    if (!exitSubmitted && mRenderState == RenderState_Exiting)
+        RenderExitScreen();
+
+    // FBOs are not shared between contexts, they go away with the one that made them.
+    ReleaseFramebuffers();
+    ReleaseFrameFences();
+    mGpuTimer.Release();
+    mStatsHud.Release();
+
+    if (GOptions.mFrameTimingCsv && mFrameTimings.Size() > 0)
+    {
+        // one file per render session, the frame counter keeps resumes from overwriting.
+        const std::string path = mAppOutputPath + "FrameTiming " + g_logFile.getLogSuffix() +
+                " #" + std::to_string(mFrameCounter) + ".csv";
+        mFrameTimings.WriteCsv(path);
+    }
+    mFrameTimings.Clear();
+
+    if (GOptions.mTestLatency && mLatencyTest.Samples() > 0)
+    {
+        mLatencyTest.LogSummary();
+        mLatencyTest.Write(mAppOutputPath + "LatencyTest " + g_logFile.getLogSuffix() +
+                " #" + std::to_string(mFrameCounter) + ".csv");
+    }
+    mLatencyTest.Reset();
+
+    mRenderEglHelper.Release();
 }
 
 
@@ -470,64 +642,34 @@ cxrError CloudXRClientOVR::CreateReceiver()
         return cxrError_Failed; // false..
     }
 
-    if (mDeviceDesc.receiveAudio)
+    if (!GOptions.mTrackingReplay.empty() && !mTrackingReplay.IsLoaded())
     {
-        // Initialize audio playback
-        oboe::AudioStreamBuilder playbackStreamBuilder;
-        playbackStreamBuilder.setDirection(oboe::Direction::Output);
-        playbackStreamBuilder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-        playbackStreamBuilder.setSharingMode(oboe::SharingMode::Exclusive);
-        playbackStreamBuilder.setFormat(oboe::AudioFormat::I16);
-        playbackStreamBuilder.setChannelCount(oboe::ChannelCount::Stereo);
-        playbackStreamBuilder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
-
-        oboe::Result r = playbackStreamBuilder.openStream(playbackStream);
-        if (r != oboe::Result::OK) {
-            CXR_LOGE("Failed to open playback stream. Error: %s", oboe::convertToText(r));
-            return cxrError_Failed;
-        }
-
-        int bufferSizeFrames = playbackStream->getFramesPerBurst() * 2;
-        r = playbackStream->setBufferSizeInFrames(bufferSizeFrames);
-        if (r != oboe::Result::OK) {
-            CXR_LOGE("Failed to set playback stream buffer size to: %d. Error: %s",
-                    bufferSizeFrames, oboe::convertToText(r));
-            return cxrError_Failed;
-        }
-
-        r = playbackStream->start();
-        if (r != oboe::Result::OK) {
-            CXR_LOGE("Failed to start playback stream. Error: %s", oboe::convertToText(r));
+        const std::string& path = GOptions.mTrackingReplay;
+        if (!mTrackingReplay.Load((path[0] == '/') ? path : mAppOutputPath + path))
             return cxrError_Failed;
-        }
     }
+    // every connection, reconnects and failovers included, replays from the top.
+    mTrackingReplay.Rewind();
+    mReplayFinished = false;
 
-    if (mDeviceDesc.sendAudio)
+    // set up before the playback stream can start pulling from it.
+    if (mDeviceDesc.receiveAudio)
     {
-        // Initialize audio recording
-        oboe::AudioStreamBuilder recordingStreamBuilder;
-        recordingStreamBuilder.setDirection(oboe::Direction::Input);
-        recordingStreamBuilder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-        recordingStreamBuilder.setSharingMode(oboe::SharingMode::Exclusive);
-        recordingStreamBuilder.setFormat(oboe::AudioFormat::I16);
-        recordingStreamBuilder.setChannelCount(oboe::ChannelCount::Stereo);
-        recordingStreamBuilder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
-        recordingStreamBuilder.setInputPreset(oboe::InputPreset::VoiceCommunication);
-        recordingStreamBuilder.setDataCallback(this);
-
-        oboe::Result r = recordingStreamBuilder.openStream(recordingStream);
-        if (r != oboe::Result::OK) {
-            CXR_LOGE("Failed to open recording stream. Error: %s", oboe::convertToText(r));
-            return cxrError_Failed;
-        }
-
-        r = recordingStream->start();
-        if (r != oboe::Result::OK) {
-            CXR_LOGE("Failed to start recording stream. Error: %s", oboe::convertToText(r));
-            return cxrError_Failed;
-        }
+        mAudioPlayback.Init(CXR_AUDIO_CHANNEL_COUNT, CXR_AUDIO_SAMPLING_RATE,
+                            GOptions.mAudioLatencyMinMs, GOptions.mAudioLatencyMaxMs);
+        mAudioStatsLast = {};
     }
 
+    // device open takes a good while and nothing needs it until we're streaming,
+    // so it overlaps receiver creation and the start of the connect.
+    std::shared_ptr<oboe::AudioStream> playback, recording;
+    cxrError audioErr = cxrError_Success;
+    GStartup.Mark(StartupTimeline::Phase_AudioOpenStarted);
+    std::thread audioOpen([this, &playback, &recording, &audioErr]() {
+        prctl(PR_SET_NAME, (long)"CXR AudioOpen", 0, 0, 0);
+        audioErr = OpenAudioStreams(playback, recording);
+    });
+
     CXR_LOGI("Trying to create Receiver at %s.", GOptions.mServerIP.c_str());
     cxrGraphicsContext context{cxrGraphicsContext_GLES};
     context.egl.display = eglGetCurrentDisplay();
@@ -561,6 +703,7 @@ cxrError CloudXRClientOVR::CreateReceiver()
                 break;
             case cxrClientState_StreamingSessionInProgress:
                 CXR_LOGI("Connection attempt succeeded.");
+                GStartup.Mark(StartupTimeline::Phase_Connected);
                 break;
             case cxrClientState_ConnectionAttemptFailed:
                 CXR_LOGE("Connection attempt failed with error: %s", cxrErrorString(error));
@@ -578,13 +721,16 @@ cxrError CloudXRClientOVR::CreateReceiver()
         CloudXRClientOVR *client = reinterpret_cast<CloudXRClientOVR*>(context);
         client->mClientState = state;
         client->mClientError = error;
+        client->WakeMainLoop();
     };
 
     s_clientProxy.LogMessage = [](void* context, cxrLogLevel level, cxrMessageCategory category, void* extra, const char* tag, const char* const messageText)
     {
         // Here we call our helper fn to output same way as the log macros will.
         // note that at the moment, we don't need/use the client context.
-        dispatchLogMsg(level, category, extra, tag, messageText);
+        // the text is already formatted, so it must not be treated as a format string.
+        if (cxrLogEnabled(level, category))
+            dispatchLogMsg(level, category, extra, tag, "%s", messageText);
     };
 
     // context is now IN the callback struct.
@@ -605,17 +751,55 @@ cxrError CloudXRClientOVR::CreateReceiver()
     if (err != cxrError_Success)
     {
         CXR_LOGE("Failed to create CloudXR receiver. Error %d, %s.", err, cxrErrorString(err));
+        audioOpen.join();
+        if (playback)
+            playback->close();
+        if (recording)
+            recording->close();
         return err;
     }
 
     // else, good to go.
     CXR_LOGI("Receiver created!");
+    GStartup.Mark(StartupTimeline::Phase_ReceiverCreated);
+
+    // only what's streamed is recorded, DoTracking skips the rest.
+    if (GOptions.mTrackingRecord && !mTrackingReplay.IsLoaded())
+        mTrackingCapture.Start(mAppOutputPath + "TrackingCapture " + g_logFile.getLogSuffix() +
+                               " #" + std::to_string(++mTrackingCaptures) + ".cxrt");
+
+    // get tracking flowing before connecting, so the first pose poll has data.
+    StartTrackingSampler();
+
+    // samples that fail before we're connected are just skipped.
+    if (GOptions.mStatsSummarySec > 0)
+        mStatsAggregator.Start(Receiver, mAppOutputPath + "ConnectionStats " + g_logFile.getLogSuffix() + ".json",
+                               GOptions.mStatsSummarySec);
 
     mConnectionDesc.async = cxrTrue;
     mConnectionDesc.useL4S = GOptions.mUseL4S;
     mConnectionDesc.clientNetwork = GOptions.mClientNetwork;
     mConnectionDesc.topology = GOptions.mTopology;
+    GStartup.Mark(StartupTimeline::Phase_ConnectStarted);
     err = cxrConnect(Receiver, GOptions.mServerIP.c_str(), &mConnectionDesc);
+
+    // the streams are only published once open, RenderAudio drops until then.
+    audioOpen.join();
+    if (audioErr != cxrError_Success)
+    {
+        TeardownReceiver();
+        return audioErr;
+    }
+    playbackStream = playback;
+    recordingStream = recording;
+    mAudioReady.store(playbackStream != nullptr, std::memory_order_release);
+    GStartup.Mark(StartupTimeline::Phase_AudioReady);
+
+    // mic audio only goes out once streaming, until then it's discarded.
+    if (recordingStream)
+        mAudioCapture.Start(Receiver, &mClientState, CXR_AUDIO_CHANNEL_COUNT, CXR_AUDIO_SAMPLING_RATE,
+                            GOptions.mMicFrameMs);
+
     if (!mConnectionDesc.async)
     {
         if (err != cxrError_Success)
@@ -628,6 +812,7 @@ cxrError CloudXRClientOVR::CreateReceiver()
         else {
             mClientState = cxrClientState_StreamingSessionInProgress;
             mRenderState = RenderState_Running;
+            GStartup.Mark(StartupTimeline::Phase_Connected);
             CXR_LOGI("Receiver created for server: %s", GOptions.mServerIP.c_str());
         }
     }
@@ -639,22 +824,132 @@ cxrError CloudXRClientOVR::CreateReceiver()
 //
 //-----------------------------------------------------------------------------
 void CloudXRClientOVR::TeardownReceiver() {
+    // sampler fires controller events into the receiver, so it goes first.
+    StopTrackingSampler();
+    mTrackingCapture.Stop();
+
+    mAudioReady.store(false, std::memory_order_release);
     if (playbackStream)
     {
+        // xrun count lives on the stream, so read it before closing.
+        oboe::ResultWithValue<int32_t> xruns = playbackStream->getXRunCount();
         playbackStream->close();
+
+        cxrAudioJitterBuffer::Stats audio;
+        mAudioPlayback.GetStats(audio);
+        CXR_LOGI("Audio playback: %u underruns, %u overruns, %u frames dropped / %u inserted for drift, "
+                 "target %.1f ms, jitter %.1f ms, %d device xruns.",
+                 audio.underruns, audio.overruns, audio.droppedFrames, audio.insertedFrames,
+                 audio.targetFrames * 1000.0f / CXR_AUDIO_SAMPLING_RATE, audio.jitterMs,
+                 xruns ? xruns.value() : -1);
     }
 
     if (recordingStream)
     {
+        // the sender calls into the receiver, and the callback stops feeding it.
+        mAudioCapture.Stop();
         recordingStream->close();
     }
 
+    // writes the session summary, and polls the receiver until joined.
+    mStatsAggregator.Stop();
+
     if (Receiver) {
         cxrDestroyReceiver(Receiver);
     }
 
     Receiver = nullptr;
     s_clientProxy = {0};
+    // controller handles die with the receiver, the next one re-adds them.
+    memset(m_newControllers, 0, sizeof(m_newControllers));
+}
+
+//-----------------------------------------------------------------------------
+// Opens and starts the Oboe streams the device desc asks for.  Runs on its own
+// thread while the receiver is created and connects, so it only fills in the
+// pointers it was handed, and leaves none of them open if it fails.
+//-----------------------------------------------------------------------------
+cxrError CloudXRClientOVR::OpenAudioStreams(std::shared_ptr<oboe::AudioStream>& playback,
+                                            std::shared_ptr<oboe::AudioStream>& recording)
+{
+    if (mDeviceDesc.receiveAudio)
+    {
+        // Initialize audio playback.  the stream pulls from our jitter buffer, so
+        // the library's audio thread never waits on the device.
+        oboe::AudioStreamBuilder playbackStreamBuilder;
+        playbackStreamBuilder.setDirection(oboe::Direction::Output);
+        playbackStreamBuilder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+        playbackStreamBuilder.setSharingMode(oboe::SharingMode::Exclusive);
+        playbackStreamBuilder.setFormat(oboe::AudioFormat::I16);
+        playbackStreamBuilder.setChannelCount(oboe::ChannelCount::Stereo);
+        playbackStreamBuilder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
+        playbackStreamBuilder.setDataCallback(this);
+
+        oboe::Result r = playbackStreamBuilder.openStream(playback);
+        if (r != oboe::Result::OK) {
+            CXR_LOGE("Failed to open playback stream. Error: %s", oboe::convertToText(r));
+            return cxrError_Failed;
+        }
+
+        // network jitter is the jitter buffer's problem, the device buffer only
+        // has to cover our callback being scheduled late.
+        int bufferSizeFrames = playback->getFramesPerBurst() * 2;
+        r = playback->setBufferSizeInFrames(bufferSizeFrames);
+        if (r != oboe::Result::OK) {
+            CXR_LOGE("Failed to set playback stream buffer size to: %d. Error: %s",
+                    bufferSizeFrames, oboe::convertToText(r));
+            playback->close();
+            playback.reset();
+            return cxrError_Failed;
+        }
+
+        r = playback->start();
+        if (r != oboe::Result::OK) {
+            CXR_LOGE("Failed to start playback stream. Error: %s", oboe::convertToText(r));
+            playback->close();
+            playback.reset();
+            return cxrError_Failed;
+        }
+    }
+
+    if (mDeviceDesc.sendAudio)
+    {
+        // Initialize audio recording
+        oboe::AudioStreamBuilder recordingStreamBuilder;
+        recordingStreamBuilder.setDirection(oboe::Direction::Input);
+        recordingStreamBuilder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+        recordingStreamBuilder.setSharingMode(oboe::SharingMode::Exclusive);
+        recordingStreamBuilder.setFormat(oboe::AudioFormat::I16);
+        recordingStreamBuilder.setChannelCount(oboe::ChannelCount::Stereo);
+        recordingStreamBuilder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
+        recordingStreamBuilder.setInputPreset(oboe::InputPreset::VoiceCommunication);
+        recordingStreamBuilder.setDataCallback(this);
+
+        oboe::Result r = recordingStreamBuilder.openStream(recording);
+        if (r != oboe::Result::OK) {
+            CXR_LOGE("Failed to open recording stream. Error: %s", oboe::convertToText(r));
+            recording.reset();
+        }
+        else
+        {
+            r = recording->start();
+            if (r != oboe::Result::OK) {
+                CXR_LOGE("Failed to start recording stream. Error: %s", oboe::convertToText(r));
+                recording->close();
+                recording.reset();
+            }
+        }
+
+        if (!recording)
+        {
+            if (playback)
+                playback->close();
+            playback.reset();
+            return cxrError_Failed;
+        }
+    }
+
+    return cxrError_Success;
 }
 
 //-----------------------------------------------------------------------------
@@ -699,6 +994,110 @@ cxrError CloudXRClientOVR::QueryChaperone(cxrDeviceDesc* deviceDesc) const
     return cxrError_Success;
 }
 
+//-----------------------------------------------------------------------------
+// Steps quality down when the connection stats keep naming a problem, and back
+// up once they've been clean a while.  Refresh changes go out live through
+// vrapi, and reach the server as HasRefresh once the change event lands.  The
+// receiver can't renegotiate resolution, bitrate or foveation mid-session, so
+// those levels are picked up by GetDeviceDesc on the next connect.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdateQualityGovernor()
+{
+    if (!GOptions.mQualityGovernor || !Receiver || mClientState != cxrClientState_StreamingSessionInProgress)
+        return;
+
+    const double nowS = GetTimeInSeconds();
+    if (nowS < mNextGovernorS)
+        return;
+    mNextGovernorS = nowS + 0.5;
+
+    cxrConnectionStats stats = {};
+    if (cxrGetConnectionStats(Receiver, &stats) != cxrError_Success)
+        return;
+    if (!mQualityGovernor.Update(stats, nowS))
+        return;
+
+    const uint32_t latencyLevel = mQualityGovernor.Level(cxrQualityGovernor::Axis_Latency);
+    const uint32_t bandwidthLevel = mQualityGovernor.Level(cxrQualityGovernor::Axis_Bandwidth);
+    CXR_LOGI("Quality governor: latency level %u, bandwidth level %u (quality %d, reasons 0x%x, rtt %u ms, "
+             "bandwidth %u kbps).  Next connect uses res factor x%.2f, bitrate x%.2f, foveation %u.",
+             latencyLevel, bandwidthLevel, (int)stats.quality, stats.qualityReasons, stats.roundTripDelayMs,
+             stats.bandwidthAvailableKbps,
+             cxrQualityGovernor::ResFactorScale(bandwidthLevel), cxrQualityGovernor::BitrateScale(bandwidthLevel),
+             cxrQualityGovernor::Foveation(GOptions.mFoveation, latencyLevel));
+
+    const float rate = GovernedDisplayRefresh();
+    if (mOvrSession == nullptr || fabsf(rate - mTargetDisplayRefresh) < 0.5f)
+        return;
+
+    // VRAPI_EVENT_DISPLAY_REFRESH_RATE_CHANGE updates mTargetDisplayRefresh and flags the server.
+    const ovrResult result = vrapi_SetDisplayRefreshRate(mOvrSession, rate);
+    if (result == ovrSuccess)
+        CXR_LOGI("Quality governor: display rate %0.2f -> %0.2f hz.", mTargetDisplayRefresh, rate);
+    else
+        CXR_LOGW("Quality governor: unable to set display rate to %0.2f, error %d.", rate, (int)result);
+}
+
+//-----------------------------------------------------------------------------
+// Device state for the clock governor.  Battery comes from sysfs, and is just
+// left unknown where that isn't readable.
+//-----------------------------------------------------------------------------
+static int32_t ReadSysfsInt(const char* path, int32_t fallback)
+{
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return fallback;
+    int32_t value = fallback;
+    if (fscanf(f, "%d", &value) != 1)
+        value = fallback;
+    fclose(f);
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+// Once a governor window, judges the frames the render thread reported and
+// moves the clock levels if needed.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdateClockGovernor()
+{
+    if (!GOptions.mClockGovernor || mOvrSession == nullptr || !mRenderThreadRunning)
+        return;
+
+    const double nowS = GetTimeInSeconds();
+    if (nowS < mNextClockGovernorS)
+        return;
+    mNextClockGovernorS = nowS + cxrClockGovernor::WindowS;
+
+    cxrClockGovernor::Device device;
+    device.throttled = vrapi_GetSystemStatusInt(&mJavaCtx, VRAPI_SYS_STATUS_THROTTLED) != 0;
+    device.batteryPct = ReadSysfsInt("/sys/class/power_supply/battery/capacity", -1);
+    const int32_t tempDeciC = ReadSysfsInt("/sys/class/power_supply/battery/temp", INT32_MIN);
+    device.batteryTempC = (tempDeciC == INT32_MIN) ? -1000.0f : tempDeciC / 10.0f;
+
+    const int32_t cpuBefore = mClockGovernor.CpuLevel();
+    const int32_t gpuBefore = mClockGovernor.GpuLevel();
+    if (!mClockGovernor.Evaluate(nowS, device))
+        return;
+
+    const ovrResult result = vrapi_SetClockLevels(mOvrSession, mClockGovernor.CpuLevel(), mClockGovernor.GpuLevel());
+    CXR_LOGI("Clock governor: cpu %d -> %d, gpu %d -> %d (%u of %u frames missed, throttled %d, battery %d%% %.1fC)%s",
+             cpuBefore, mClockGovernor.CpuLevel(), gpuBefore, mClockGovernor.GpuLevel(),
+             mClockGovernor.LastMissed(), mClockGovernor.LastFrames(), device.throttled ? 1 : 0,
+             device.batteryPct, device.batteryTempC, (result == ovrSuccess) ? "" : ", vrapi refused");
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+float CloudXRClientOVR::GovernedDisplayRefresh() const
+{
+    if (mGovernorRefreshRates.empty())
+        return mTargetDisplayRefresh;
+
+    const uint32_t level = mQualityGovernor.Level(cxrQualityGovernor::Axis_Latency);
+    return mGovernorRefreshRates[std::min<size_t>(level, mGovernorRefreshRates.size() - 1)];
+}
+
 //-----------------------------------------------------------------------------
 // Note: here we try to detect controllers up-front.  We may need to do this
 // post-connect, if we don't detect any, or don't detect two.  Also note that
@@ -706,37 +1105,12 @@ cxrError CloudXRClientOVR::QueryChaperone(cxrDeviceDesc* deviceDesc) const
 //-----------------------------------------------------------------------------
 void CloudXRClientOVR::DetectControllers()
 {
-    // determine class of Oculus device
-    mControllersFound = 0;
-    uint32_t deviceIndex = 0;
-    ovrInputCapabilityHeader capsHeader;
-    ovrResult result;
+    mControllers.Invalidate();
+    mControllers.Refresh(mOvrSession);
 
-    while (true)
-    {
-        result = vrapi_EnumerateInputDevices(mOvrSession, deviceIndex, &capsHeader);
-        if (result != ovrSuccess)
-        {
-            CXR_LOGE("Failed to enumerate device %d, error = %d", deviceIndex, result);
-            break; // we're done if this call fails.
-        }
-        else
-        {
-            CXR_LOGE("Found device %d, type = 0x%0x", deviceIndex, capsHeader.Type);
-        }
-        ++deviceIndex;
-        if (capsHeader.Type == ovrControllerType_TrackedRemote)
-        {
-            ovrInputTrackedRemoteCapabilities remoteCaps;
-            remoteCaps.Header = capsHeader;
-            vrapi_GetInputDeviceCapabilities(mOvrSession, &remoteCaps.Header);
-            if (remoteCaps.ControllerCapabilities & ovrControllerCaps_ModelOculusTouch)
-            {
-                mControllersFound++;
-                // TODO do we set up our internal state tracking of controllers here???
-            }
-        }
-    }
+    ControllerRegistry::Snapshot controllers;
+    mControllers.Get(controllers);
+    mControllersFound = controllers.count;
 
     if (0==mControllersFound)
     {
@@ -753,36 +1127,45 @@ void CloudXRClientOVR::DetectControllers()
 //-----------------------------------------------------------------------------
 bool CloudXRClientOVR::SetupFramebuffer(GLuint colorTexture, uint32_t eye)
 {
-    if(Framebuffers[eye] == 0)
+    // texture names can be recycled once the pool destroys a chain, so a stale
+    // entry could alias a new texture.  drop them all and rebuild on demand.
+    if (mFramebuffersStale)
+        ReleaseFramebuffers();
+
+    FramebufferMap& eyeFramebuffers = Framebuffers[eye];
+    const auto it = eyeFramebuffers.find(colorTexture);
+    if (it == eyeFramebuffers.end())
     {
         GLuint framebuffer;
 
         glGenFramebuffers(1, &framebuffer);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-            GL_TEXTURE_2D, colorTexture, 0);
+        if (GOptions.mArraySwapchain)
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                colorTexture, 0, eye);
+        else
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                GL_TEXTURE_2D, colorTexture, 0);
 
         GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
         if (status != GL_FRAMEBUFFER_COMPLETE)
         {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &framebuffer);
             CXR_LOGI("Incomplete frame buffer object!");
             return false;
         }
 
-        Framebuffers[eye] = framebuffer;
+        eyeFramebuffers[colorTexture] = framebuffer;
 
         CXR_LOGI("Created FBO %d for eye%d texture %d.",
             framebuffer, eye, colorTexture);
-
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, Framebuffers[eye]);
     }
     else
     {
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, Framebuffers[eye]);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                               GL_TEXTURE_2D, colorTexture, 0);
+        // already attached and checked when created, binding is all we need.
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, it->second);
     }
 
     glViewport(0, 0, EyeWidth[eye], EyeHeight[eye]);
@@ -791,7 +1174,136 @@ bool CloudXRClientOVR::SetupFramebuffer(GLuint colorTexture, uint32_t eye)
 }
 
 //-----------------------------------------------------------------------------
-void CloudXRClientOVR::FillBackground()
+// Must run on the thread whose context created the FBOs.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::ReleaseFramebuffers()
+{
+    for (auto& eyeFramebuffers : Framebuffers)
+    {
+        for (const auto& fbo : eyeFramebuffers)
+            glDeleteFramebuffers(1, &fbo.second);
+        eyeFramebuffers.clear();
+    }
+    mFramebuffersStale = false;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::ReleaseFrameFences()
+{
+    for (auto& fence : mFrameFences)
+    {
+        if (fence)
+            EGLHelper::ReleaseFence(fence);
+        fence = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Counts every frame, but only asks for stats and redraws the text once per
+// StatsHud::UpdateIntervalS.  The swapchain is made on first use, so the
+// option can also be turned on over the control socket.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdateStatsHud(const FrameTimingRecord& timing)
+{
+    if (!GOptions.mStatsHud || mStatsHudFailed)
+        return;
+    if (!mStatsHud.IsReady())
+    {
+        mStatsHudFailed = !mStatsHud.Initialize();
+        mHudFrames = mHudRepeated = mHudMissed = 0;
+        mHudLatchMsSum = 0;
+        mHudWindowStartS = GetTimeInSeconds();
+        return;
+    }
+
+    const bool streaming = (mClientState == cxrClientState_StreamingSessionInProgress);
+    mHudFrames++;
+    mHudLatchMsSum += timing.latchWaitMs;
+    if (timing.kind == FrameKind_Repeated)
+        mHudRepeated++;
+    else if (timing.kind == FrameKind_Background && streaming)
+        mHudMissed++;
+
+    const double nowS = GetTimeInSeconds();
+    if (!mStatsHud.UpdateDue(nowS))
+        return;
+
+    const double elapsedS = std::fmax(nowS - mHudWindowStartS, 0.001);
+    char text[StatsHud::MaxLines][64] = {};
+    uint32_t lineCount = 0;
+
+    cxrConnectionStats stats = {};
+    if (streaming && Receiver && cxrGetConnectionStats(Receiver, &stats) == cxrError_Success)
+    {
+        mStatsHud.AddLatencySample((float)stats.roundTripDelayMs);
+        snprintf(text[lineCount++], 64, "FPS %5.1f stream  %5.1f display", stats.framesPerSecond,
+                 mHudFrames / elapsedS);
+        snprintf(text[lineCount++], 64, "Bitrate %6u kbps  avail %6u", stats.bandwidthUtilizationKbps,
+                 stats.bandwidthAvailableKbps);
+        snprintf(text[lineCount++], 64, "RTT %3u ms  p50 %3.0f  p90 %3.0f  p99 %3.0f", stats.roundTripDelayMs,
+                 mStatsHud.LatencyPercentile(50), mStatsHud.LatencyPercentile(90), mStatsHud.LatencyPercentile(99));
+        snprintf(text[lineCount++], 64, "Jitter %5.1f ms  queue %5.1f ms", stats.jitterUs * 0.001f,
+                 stats.frameQueueTimeMs);
+        snprintf(text[lineCount++], 64, "Quality [%c%c%c%c%c]  reasons 0x%x",
+                 stats.quality >= cxrConnectionQuality_Bad ? '#' : '_',
+                 stats.quality >= cxrConnectionQuality_Poor ? '#' : '_',
+                 stats.quality >= cxrConnectionQuality_Fair ? '#' : '_',
+                 stats.quality >= cxrConnectionQuality_Good ? '#' : '_',
+                 stats.quality == cxrConnectionQuality_Excellent ? '#' : '_', stats.qualityReasons);
+        snprintf(text[lineCount++], 64, "Packets lost %u  dropped %u", stats.totalPacketsLost,
+                 stats.totalPacketsDropped);
+    }
+    else
+    {
+        snprintf(text[lineCount++], 64, "Not streaming, state %d", (int)mClientState.load());
+        snprintf(text[lineCount++], 64, "Display %5.1f fps", mHudFrames / elapsedS);
+    }
+    snprintf(text[lineCount++], 64, "Repeated %4.1f/s  missed %4.1f/s", mHudRepeated / elapsedS,
+             mHudMissed / elapsedS);
+    snprintf(text[lineCount++], 64, "Latch wait %4.1f ms  GPU %4.2f ms",
+             mHudFrames ? mHudLatchMsSum / mHudFrames : 0.0f, std::fmax(mGpuLastMs, 0.0f));
+
+    const char* lines[StatsHud::MaxLines];
+    for (uint32_t i = 0; i < lineCount; i++)
+        lines[i] = text[i];
+    mStatsHud.Update(lines, lineCount, nowS);
+
+    mHudFrames = mHudRepeated = mHudMissed = 0;
+    mHudLatchMsSum = 0;
+    mHudWindowStartS = nowS;
+}
+
+//-----------------------------------------------------------------------------
+// Timer results land GpuTimer::Latency frames after the frame they're for.
+// Returns the frame's total, < 0 if none of its scopes were timed.
+//-----------------------------------------------------------------------------
+float CloudXRClientOVR::AddGpuTiming(const GpuTimer::Result& result)
+{
+    float totalMs = 0;
+    bool timed = false;
+    for (uint32_t eye = 0; eye < GpuTimer::MaxScopes; eye++)
+    {
+        totalMs += std::fmax(result.ms[eye], 0.0f);
+        timed |= result.ms[eye] >= 0;
+    }
+
+    if (FrameTimingRecord* record = mFrameTimings.Find(result.frameIndex))
+    {
+        record->gpuEyeMs[0] = result.ms[0];
+        record->gpuEyeMs[1] = result.ms[1];
+    }
+
+    mGpuLastMs = totalMs;
+    mGpuMsSum += totalMs;
+    mGpuMsMax = std::fmax(mGpuMsMax, totalMs);
+    mGpuMsCount++;
+    return timed ? totalMs : -1.0f;
+}
+
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::FillBackground()
 {
     float cr = ((mBGColor & 0x00FF0000) >> 16) / 255.0f;
     float cg = ((mBGColor & 0x0000FF00) >> 8) / 255.0f;
@@ -803,6 +1315,10 @@ void CloudXRClientOVR::FillBackground()
 
 
 //-----------------------------------------------------------------------------
+// Rotate the orientation of the controller to match the Quest pose with the Touch SteamVR model
+// 0.45 radians about X, as a quaternion.
+static const cxrQuaternion s_questToTouchRotation = { cosf(0.225f), sinf(0.225f), 0.0f, 0.0f };
+
 static constexpr int inputCountQuest = 21;
 
 static const char* inputPathsQuest[inputCountQuest] =
@@ -897,6 +1413,14 @@ const int ovrBitsToInput[32] = { // ovr bit index -> client input index
     8, // joystick click
 };
 
+// client input index of each analog axis, in AnalogAxis order.
+const uint32_t analogInputIndex[4] = {
+    4, // /input/trigger/value
+    7, // /input/grip/value
+    10, // /input/joystick/x
+    11, // /input/joystick/y
+};
+
 const int ovrTouchToInput[16] = { // ovr touch bit index -> client input index
     16, // A
     17, // B
@@ -925,6 +1449,9 @@ const int ovrTouchToInput[16] = { // ovr touch bit index -> client input index
 //-----------------------------------------------------------------------------
 void CloudXRClientOVR::ProcessControllers(float predictedTimeS)
 {
+    for (bool& valid : mControllerPoseValid)
+        valid = false;
+
     if (mClientState != cxrClientState_StreamingSessionInProgress)
     {
         // there might be a reason a given app wants to process the controllers regardless.
@@ -934,66 +1461,49 @@ void CloudXRClientOVR::ProcessControllers(float predictedTimeS)
     }
 
     // 64 should be more than large enough. 2x32b masks that are < half used, plus scalars.
+    // both hands are gathered first and submitted together at the end of the poll.
     cxrControllerEvent events[MAX_CONTROLLERS][64] = {};
     uint32_t eventCount[MAX_CONTROLLERS] = {};
 
-    uint32_t deviceIndex = 0, controllerIndex = 0;
-    ovrInputCapabilityHeader capsHeader;
-    while (vrapi_EnumerateInputDevices(mOvrSession, deviceIndex, &capsHeader) >= 0)
-    {
-        ++deviceIndex;
-        if (capsHeader.Type != ovrControllerType_TrackedRemote)
-            continue; // quick loop, rather than indenting all the rest of the fn.
-
-        // FIRST check capabilities, detect hand index
-        ovrInputTrackedRemoteCapabilities remoteCaps;
-        remoteCaps.Header = capsHeader;
-        vrapi_GetInputDeviceCapabilities(mOvrSession, &remoteCaps.Header);
-        const int32_t handIndex = (remoteCaps.ControllerCapabilities&ovrControllerCaps_RightHand)
-                                  ? 1 : 0;
-
-        // for the moment, we're hacking in the controller ADD here, first time we
-        // detect controller N available.  It's not a horrible solution, where devices
-        // can wake/sleep, and their API doesn't seem to have events/status for that.
-        // TODO: ensure we have some ID->index to keep linked when sleep.
+    // devices are only enumerated when something changed, or on a slow timer to
+    // catch controllers that slept and woke.  the per-poll path is just reads.
+    mControllers.RefreshIfDue(mOvrSession, GetTimeInSeconds());
+    ControllerRegistry::Snapshot controllers;
+    mControllers.Get(controllers);
+
+    for (uint32_t handIndex = 0; handIndex < MAX_CONTROLLERS; ++handIndex)
+    {
+        const ControllerRegistry::Controller& ctl = controllers.hands[handIndex];
+        if (!ctl.present)
+            continue;
+
+        // controllers are added to the receiver the first time we see a hand.  the
+        // registry keeps hand index as the identity, so a controller that sleeps and
+        // comes back with a new DeviceID still maps to the same cxr controller.
         if (!m_newControllers[handIndex]) // null, so open to create+add
         {
-            cxrControllerDesc desc = {};
-            //desc.id = capsHeader.DeviceID; // turns out this is NOT UNIQUE.  it's a fixed starting number, incremented, and thus devices can 'swap' IDs.
-            desc.id = handIndex; // so for now, we're going to just use handIndex, as we're guaranteed left+right will remain 0+1 always.
-            desc.role = handIndex?"cxr://input/hand/right":"cxr://input/hand/left";
-            desc.controllerName = "Oculus Touch";
-            desc.inputCount = inputCountQuest;
-            desc.inputPaths = inputPathsQuest;
-            desc.inputValueTypes = inputValueTypesQuest;
-            CXR_LOGI("Adding controller index %u, ID %llu, role %s", handIndex, desc.id, desc.role);
-            CXR_LOGI("Controller caps bits = 0x%08x", capsHeader.DeviceID, remoteCaps.ControllerCapabilities);
-            cxrError e = cxrAddController(Receiver, &desc, &m_newControllers[handIndex]);
-            if (e!=cxrError_Success)
-            {
-                CXR_LOGE("Error adding controller: %s", cxrErrorString(e));
-                // TODO!!! proper example for client to handle client-call errors, fatal vs 'notice'.
+            CXR_LOGI("Controller caps bits = 0x%08x", ctl.controllerCaps);
+            if (!AddReceiverController(handIndex))
                 continue;
-            }
         }
 
         // SECOND handle pose/tracking, to get it out of the way of input events...
         // Must use predicted time or tracking will not be filtered and will jitter/jump
         ovrTracking tracking;
         if (vrapi_GetInputTrackingState(
-                mOvrSession, capsHeader.DeviceID, predictedTimeS, &tracking) < 0)
+                mOvrSession, ctl.deviceID, predictedTimeS, &tracking) < 0)
         {
-            CXR_LOGE("vrapi_GetInputTrackingState failed, index %u", deviceIndex-1);
-            // TODO: maybe mark this as remove controller, or controller-sleep?
-            //  may need to review error codes....
+            CXR_LOGE("vrapi_GetInputTrackingState failed, hand %u", handIndex);
+            // device likely went to sleep or swapped IDs, re-enumerate on next poll.
+            mControllers.Invalidate();
             continue;
         }
 
         auto& controller = TrackingState.controller[handIndex];
 
-        // Rotate the orientation of the controller to match the Quest pose with the Touch SteamVR model
-        const float QUEST_TO_TOUCH_ROT = 0.45f; // radians
-        controller.pose = ConvertPose(tracking.HeadPose, QUEST_TO_TOUCH_ROT);
+        // converted along with the HMD in DoTracking, in one batch.
+        mControllerRawPose[handIndex] = tracking.HeadPose;
+        mControllerPoseValid[handIndex] = true;
 
         // TODO tracking.status has a bunch of flags to inform active state.
         controller.pose.deviceIsConnected = cxrTrue;
@@ -1006,55 +1516,32 @@ void CloudXRClientOVR::ProcessControllers(float predictedTimeS)
         // THIRD, we grab the current input state, and then we'll compare against
         // prior state and generate any events we need to pass to server.
         ovrInputStateTrackedRemote input;
-        input.Header.ControllerType = capsHeader.Type;
+        input.Header.ControllerType = ovrControllerType_TrackedRemote;
         if (vrapi_GetCurrentInputState(
-                mOvrSession, capsHeader.DeviceID, &input.Header) < 0)
+                mOvrSession, ctl.deviceID, &input.Header) < 0)
         {
-            CXR_LOGE("vrapi_GetCurrentInputState failed, index %u", deviceIndex-1);
-            // TODO: maybe mark this as remove controller, or controller-sleep?
-            //  may need to review error codes....
+            CXR_LOGE("vrapi_GetCurrentInputState failed, hand %u", handIndex);
+            mControllers.Invalidate();
             continue;
         }
 
         const uint64_t inputTimeNS = GetTimeInNS();
 
         // Let's deal with the scalars up front, since we know what they are.
-        // TODO: we could use a compare fn here to filter out tiny changes,
-        //  but then we'd need to track value last time we sent events...
-        if (input.IndexTrigger != mLastInputState[handIndex].IndexTrigger)
-        {
-            cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
-            e.clientTimeNS = inputTimeNS;
-            e.clientInputIndex = 4;
-            e.inputValue.valueType = cxrInputValueType_float32;
-            e.inputValue.vF32 = input.IndexTrigger;
-        }
-
-        if (input.GripTrigger != mLastInputState[handIndex].GripTrigger)
-        {
-            cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
-            e.clientTimeNS = inputTimeNS;
-            e.clientInputIndex = 7;
-            e.inputValue.valueType = cxrInputValueType_float32;
-            e.inputValue.vF32 = input.GripTrigger;
-        }
-
-        if (input.Joystick.x != mLastInputState[handIndex].Joystick.x)
-        {
-            cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
-            e.clientTimeNS = inputTimeNS;
-            e.clientInputIndex = 10;
-            e.inputValue.valueType = cxrInputValueType_float32;
-            e.inputValue.vF32 = input.Joystick.x;
-        }
-
-        if (input.Joystick.y != mLastInputState[handIndex].Joystick.y)
+        // each goes through its filter, which compares against the value last
+        // sent rather than last polled, so noise is dropped but drift isn't.
+        const float analogValues[AnalogAxisCount] = {
+            input.IndexTrigger, input.GripTrigger, input.Joystick.x, input.Joystick.y };
+        for (uint32_t axis = 0; axis < AnalogAxisCount; axis++)
         {
+            float value;
+            if (!mAnalogFilters[handIndex][axis].Filter(analogValues[axis], inputTimeNS, value))
+                continue;
             cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
             e.clientTimeNS = inputTimeNS;
-            e.clientInputIndex = 11;
+            e.clientInputIndex = analogInputIndex[axis];
             e.inputValue.valueType = cxrInputValueType_float32;
-            e.inputValue.vF32 = input.Joystick.y;
+            e.inputValue.vF32 = value;
         }
 
         // okay, now the 'hard' part.  we need to loop through our static arrays
@@ -1108,49 +1595,104 @@ void CloudXRClientOVR::ProcessControllers(float predictedTimeS)
             }
         }
 
-        if (eventCount[handIndex])
-        {
-            cxrError err = cxrFireControllerEvents(Receiver, m_newControllers[handIndex], events[handIndex], eventCount[handIndex]);
-            if (err != cxrError_Success)
-            {
-                CXR_LOGE("cxrFireControllerEvents failed: %s", cxrErrorString(err));
-                // TODO: how to handle UNUSUAL API errors? might just return up.
-                throw("Error firing events"); // just to do something fatal until we can propagate and 'handle' it.
-            }
-            // save input state for easy comparison next time, ONLY if we sent the events...
-            mLastInputState[handIndex] = input;
-        }
+        // every change found was queued above, so this is now the state the server has.
+        mLastInputState[handIndex].Buttons = input.Buttons;
+        mLastInputState[handIndex].Touches = input.Touches;
+    }
 
-        // clear event count.
-        eventCount[handIndex] = 0;
+    for (uint32_t handIndex = 0; handIndex < MAX_CONTROLLERS; ++handIndex)
+    {
+        if (!eventCount[handIndex])
+            continue;
+        if (mTrackingCapture.IsRecording())
+            mTrackingCapture.RecordEvents((int64_t)GetTimeInNS(), handIndex, events[handIndex], eventCount[handIndex]);
+        cxrError err = cxrFireControllerEvents(Receiver, m_newControllers[handIndex], events[handIndex], eventCount[handIndex]);
+        // this can run on the sampler thread, where nothing would catch a throw, so
+        // the batch is dropped as the replay path does.  a lost connection surfaces
+        // through the state callback.
+        if (err != cxrError_Success)
+            CXR_LOGE("cxrFireControllerEvents failed, %u events dropped: %s", eventCount[handIndex], cxrErrorString(err));
     }
 }
 
 //-----------------------------------------------------------------------------
 //
 //-----------------------------------------------------------------------------
-cxrTrackedDevicePose CloudXRClientOVR::ConvertPose(
-        const ovrRigidBodyPosef& inPose, float rotationX)
+bool CloudXRClientOVR::AddReceiverController(uint32_t handIndex)
 {
-    ovrMatrix4f transform = vrapi_GetTransformFromPose(&inPose.Pose);
-
-    if(rotationX)
+    cxrControllerDesc desc = {};
+    desc.id = handIndex; // vrapi DeviceIDs are NOT UNIQUE across sleep, left+right will remain 0+1 always.
+    desc.role = handIndex?"cxr://input/hand/right":"cxr://input/hand/left";
+    desc.controllerName = "Oculus Touch";
+    desc.inputCount = inputCountQuest;
+    desc.inputPaths = inputPathsQuest;
+    desc.inputValueTypes = inputValueTypesQuest;
+    CXR_LOGI("Adding controller index %u, ID %llu, role %s", handIndex, desc.id, desc.role);
+    cxrError e = cxrAddController(Receiver, &desc, &m_newControllers[handIndex]);
+    if (e!=cxrError_Success)
     {
-        const ovrMatrix4f rotation = ovrMatrix4f_CreateRotation( rotationX, 0, 0 );
-        transform = ovrMatrix4f_Multiply( &transform, &rotation );
+        CXR_LOGE("Error adding controller: %s", cxrErrorString(e));
+        // TODO!!! proper example for client to handle client-call errors, fatal vs 'notice'.
+        return false;
     }
+    // a new controller on the server starts from rest.
+    ResetInputState(handIndex);
+    return true;
+}
 
-    cxrTrackedDevicePose pose{};
-    cxrMatrix34 m = cxrConvert(transform);
-    cxrMatrixToVecQuat(&m, &pose.position, &pose.rotation);
-    pose.velocity = cxrConvert(inPose.LinearVelocity);
-    pose.angularVelocity = cxrConvert(inPose.AngularVelocity);
-    pose.acceleration = cxrConvert(inPose.LinearAcceleration);
-    pose.angularAcceleration = cxrConvert(inPose.AngularAcceleration);
+//-----------------------------------------------------------------------------
+// Configures the analog filters from options, and forgets what was last sent.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::ResetInputState(uint32_t handIndex)
+{
+    const uint64_t minIntervalNS = (GOptions.mInputAxisRate > 0)
+            ? (uint64_t)(1e9 / GOptions.mInputAxisRate) : 0;
 
-    pose.poseIsValid = cxrTrue;
+    memset(&mLastInputState[handIndex], 0, sizeof(mLastInputState[handIndex]));
+    for (uint32_t axis = 0; axis < AnalogAxisCount; axis++)
+    {
+        const bool centered = (axis == AnalogAxis_JoystickX || axis == AnalogAxis_JoystickY);
+        cxrAnalogInputFilter& filter = mAnalogFilters[handIndex][axis];
+        filter.Configure(centered ? -1.0f : 0.0f, 1.0f, centered,
+                GOptions.mInputDeadband, GOptions.mInputQuantize, minIntervalNS);
+        filter.Reset();
+    }
+}
 
-    return pose;
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::ConvertPoses(const ovrRigidBodyPosef* const inPoses[],
+        const cxrQuaternion* const rotations[], cxrTrackedDevicePose* const outPoses[], uint32_t count)
+{
+    // orientation * rotation stays in quaternion space, the same as multiplying
+    // the transforms and converting back, minus the matrices.  translation is
+    // unaffected by a local rotation.  vrapi quaternions are xyzw.
+    cxrQuaternion4 orientation, rotation, result;
+    cxrQuat4SetIdentity(&orientation);
+    cxrQuat4SetIdentity(&rotation);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const ovrQuatf& q = inPoses[i]->Pose.Orientation;
+        const cxrQuaternion in = { q.w, q.x, q.y, q.z };
+        cxrQuat4Set(&orientation, i, &in);
+        if (rotations[i])
+            cxrQuat4Set(&rotation, i, rotations[i]);
+    }
+    cxrQuatMultiply4(&orientation, &rotation, &result);
+    cxrQuatCanonicalize4(&result);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const ovrRigidBodyPosef& inPose = *inPoses[i];
+        cxrTrackedDevicePose& pose = *outPoses[i];
+        pose.position = cxrConvert(inPose.Pose.Position);
+        pose.rotation = cxrQuat4Get(&result, i);
+        pose.velocity = cxrConvert(inPose.LinearVelocity);
+        pose.angularVelocity = cxrConvert(inPose.AngularVelocity);
+        pose.acceleration = cxrConvert(inPose.LinearAcceleration);
+        pose.angularAcceleration = cxrConvert(inPose.AngularAcceleration);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -1158,11 +1700,20 @@ cxrTrackedDevicePose CloudXRClientOVR::ConvertPose(
 //-----------------------------------------------------------------------------
 void CloudXRClientOVR::DoTracking(double predictedTimeS)
 {
+    if (mTrackingReplay.IsLoaded())
+    {
+        DoReplayTracking(predictedTimeS);
+        return;
+    }
+
     ProcessControllers(predictedTimeS);
+    if (GOptions.mTestLatency && !Receiver)
+        PollLatencyTestInput();
 
     ovrTracking2_ tracking = vrapi_GetPredictedTracking2(mOvrSession, predictedTimeS);
 
-    TrackingState.poseTimeOffset = ClientPredictionOffset;
+    TrackingState.poseTimeOffset = (GOptions.mPredictionMode == CloudXR::PredictionMode_Adaptive)
+            ? (float)mPredictionHorizon : ClientPredictionOffset;
 
     TrackingState.hmd.ipd = vrapi_GetInterpupillaryDistance(&tracking);
     // the quest2 ipd sensor reports infinitesimal changes every frame, even when the user has not adjusted the headset IPD
@@ -1175,16 +1726,192 @@ void CloudXRClientOVR::DoTracking(double predictedTimeS)
     {
         TrackingState.hmd.displayRefresh = std::fminf(mTargetDisplayRefresh, 90.0f);
         TrackingState.hmd.flags |= cxrHmdTrackingFlags_HasRefresh;
-        // TODO: should we have this mutex protected so no race condition on it?
-        mRefreshChanged = false;
+        // when sampling on our own thread, a given sample may never reach the server,
+        // so the flag stays set until GetTrackingState actually hands one out.
+        if (!mTrackingThreadRunning)
+            mRefreshChanged = false;
     }
 
     mLastHeadPose = tracking.HeadPose;
-    TrackingState.hmd.pose = ConvertPose(tracking.HeadPose);
+
+    // convert HMD and whichever controllers tracked this poll together.
+    const ovrRigidBodyPosef* inPoses[1 + MAX_CONTROLLERS] = { &tracking.HeadPose };
+    const cxrQuaternion* rotations[1 + MAX_CONTROLLERS] = { nullptr };
+    cxrTrackedDevicePose* outPoses[1 + MAX_CONTROLLERS] = { &TrackingState.hmd.pose };
+    uint32_t poseCount = 1;
+    for (uint32_t handIndex = 0; handIndex < MAX_CONTROLLERS; ++handIndex)
+    {
+        if (!mControllerPoseValid[handIndex])
+            continue;
+        inPoses[poseCount] = &mControllerRawPose[handIndex];
+        rotations[poseCount] = &s_questToTouchRotation;
+        outPoses[poseCount] = &TrackingState.controller[handIndex].pose;
+        poseCount++;
+    }
+    ConvertPoses(inPoses, rotations, outPoses, poseCount);
+
     TrackingState.hmd.pose.poseIsValid = ((tracking.Status & VRAPI_TRACKING_STATUS_ORIENTATION_VALID) > 0) ? cxrTrue : cxrFalse;
     TrackingState.hmd.pose.deviceIsConnected = ((tracking.Status & VRAPI_TRACKING_STATUS_HMD_CONNECTED) > 0) ? cxrTrue : cxrFalse;
     TrackingState.hmd.pose.trackingResult = cxrTrackingResult_Running_OK;
     TrackingState.hmd.activityLevel = cxrDeviceActivityLevel_UserInteraction;
+
+    if (mTrackingCapture.IsRecording() && mClientState == cxrClientState_StreamingSessionInProgress)
+        mTrackingCapture.RecordTracking((int64_t)GetTimeInNS(), TrackingState);
+    if (GOptions.mTestLatency && mClientState == cxrClientState_StreamingSessionInProgress)
+        mLatencyTest.PoseSent(TrackingState.hmd.pose, GetTimeInSeconds());
+}
+
+//-----------------------------------------------------------------------------
+// Without a server ProcessControllers has nothing to send to, so the local
+// latency test reads the buttons it cares about here.  A or X or either
+// trigger, pressed or released, is an edge.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::PollLatencyTestInput()
+{
+    mControllers.RefreshIfDue(mOvrSession, GetTimeInSeconds());
+    ControllerRegistry::Snapshot controllers;
+    mControllers.Get(controllers);
+
+    bool pressed = false;
+    for (uint32_t handIndex = 0; handIndex < MAX_CONTROLLERS; ++handIndex)
+    {
+        const ControllerRegistry::Controller& ctl = controllers.hands[handIndex];
+        if (!ctl.present)
+            continue;
+
+        ovrInputStateTrackedRemote input;
+        input.Header.ControllerType = ovrControllerType_TrackedRemote;
+        if (vrapi_GetCurrentInputState(mOvrSession, ctl.deviceID, &input.Header) < 0)
+        {
+            mControllers.Invalidate();
+            continue;
+        }
+        pressed |= (input.Buttons & (ovrButton_A | ovrButton_X | ovrButton_Trigger)) != 0;
+    }
+
+    mLatencyTest.InputPolled(pressed, GetTimeInSeconds());
+}
+
+//-----------------------------------------------------------------------------
+// Stands in for the headset and controllers with a recorded capture.  The
+// first recorded pose is held until streaming starts, which starts the replay
+// clock, so every run sends the server the same input at the same offsets
+// into the session.  Prediction and refresh changes stay live, they belong to
+// this run's display, and the layer still gets the real head pose so the
+// compositor doesn't reproject against a head that isn't moving that way.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::DoReplayTracking(double predictedTimeS)
+{
+    const int64_t nowNs = (int64_t)GetTimeInNS();
+    const bool streaming = (mClientState == cxrClientState_StreamingSessionInProgress);
+    if (streaming && !mTrackingReplay.IsStarted())
+    {
+        mTrackingReplay.Start(nowNs);
+        CXR_LOGI("Tracking replay started, %.1f s of input.", mTrackingReplay.DurationS());
+    }
+
+    mLastHeadPose = vrapi_GetPredictedTracking2(mOvrSession, predictedTimeS).HeadPose;
+
+    const float poseTimeOffset = (GOptions.mPredictionMode == CloudXR::PredictionMode_Adaptive)
+            ? (float)mPredictionHorizon : ClientPredictionOffset;
+    mTrackingReplay.TrackingAt(nowNs, TrackingState);
+    TrackingState.poseTimeOffset = poseTimeOffset;
+    TrackingState.hmd.flags &= ~cxrHmdTrackingFlags_HasRefresh;
+    if (mRefreshChanged)
+    {
+        TrackingState.hmd.displayRefresh = std::fminf(mTargetDisplayRefresh, 90.0f);
+        TrackingState.hmd.flags |= cxrHmdTrackingFlags_HasRefresh;
+        if (!mTrackingThreadRunning)
+            mRefreshChanged = false;
+    }
+
+    if (!streaming)
+        return;
+
+    uint32_t handIndex;
+    while (mTrackingReplay.NextEvents(nowNs, handIndex, mReplayEvents))
+    {
+        if (handIndex >= MAX_CONTROLLERS)
+            continue;
+        if (!m_newControllers[handIndex] && !AddReceiverController(handIndex))
+            continue;
+        cxrError err = cxrFireControllerEvents(Receiver, m_newControllers[handIndex], mReplayEvents.data(),
+                                               (uint32_t)mReplayEvents.size());
+        if (err != cxrError_Success)
+            CXR_LOGE("cxrFireControllerEvents failed during replay: %s", cxrErrorString(err));
+    }
+
+    // a replay run is a benchmark run, it ends itself once the input runs out.
+    if (!mReplayFinished && mTrackingReplay.IsFinished(nowNs))
+    {
+        mReplayFinished = true;
+        CXR_LOGI("Tracking replay finished.");
+        RequestExit();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+double CloudXRClientOVR::GetPredictedTrackingTime()
+{
+    // Unless the predicted time is used, tracking state will not be
+    // filtered and as a result view will be jumping all over the place.
+    if (GOptions.mPredictionMode != CloudXR::PredictionMode_Adaptive)
+        return ClientPredictionOffset == 0.0 ? 0.0 : GetTimeInSeconds() + ClientPredictionOffset;
+
+    // Adaptive: the pose we send now comes back in a frame roughly a pipeline latency
+    // from now, and that frame is scanned out on a display vsync.  So target the first
+    // display time at or beyond now + latency, using the last known display time as phase.
+    const double displayTimeS = mNextDisplayTime;
+    if (displayTimeS <= 0)
+        return 0.0; // not rendering yet, nothing to align to.
+
+    const double nowS = GetTimeInSeconds();
+    const double periodS = 1.0 / std::fmax(mTargetDisplayRefresh, 1.0f);
+    const double wantedS = nowS + std::fmin((double)mPipelineLatency, MaxPredictionHorizon);
+
+    double targetS = displayTimeS;
+    if (targetS < wantedS)
+        targetS += ceil((wantedS - targetS) / periodS) * periodS;
+
+    // rounding up can carry us past the cap, step back to the last vsync inside it.
+    const double maxS = nowS + MaxPredictionHorizon;
+    if (targetS > maxS)
+        targetS -= ceil((targetS - maxS) / periodS) * periodS;
+
+    mPredictionHorizon = (float)(targetS - nowS);
+    return targetS;
+}
+
+//-----------------------------------------------------------------------------
+// Called once per rendered frame with how long we waited in cxrLatchFrame.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdatePredictionLatency(double latchWaitS)
+{
+    const float alpha = 0.1f; // smooth over ~10 frames
+    mLatchWaitAvg += alpha * ((float)latchWaitS - mLatchWaitAvg);
+
+    // mStats only refreshes every few seconds, which is fine for the network term.
+    const float networkS = (mStats.roundTripDelayMs + mStats.frameQueueTimeMs) * 0.001f;
+    mPipelineLatency = networkS + mLatchWaitAvg;
+}
+
+//-----------------------------------------------------------------------------
+// Residual error: the latched frame was rendered with the pose we predicted for
+// this display time, compare it against where vrapi says the head will be then.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdatePredictionError(const cxrMatrix34& renderedPose)
+{
+    const ovrTracking2 actual = vrapi_GetPredictedTracking2(mOvrSession, mNextDisplayTime);
+    const ovrQuatf& a = actual.HeadPose.Pose.Orientation;
+    const ovrQuatf r = cxrToQuaternion(renderedPose);
+
+    const float dot = std::fmin(1.0f, fabsf(a.x*r.x + a.y*r.y + a.z*r.z + a.w*r.w));
+    const float errorDeg = 2.0f * acosf(dot) * (180.0f / VRAPI_PI);
+
+    const float alpha = 0.1f;
+    mPredictionErrorDeg += alpha * (errorDeg - mPredictionErrorDeg);
 }
 
 //-----------------------------------------------------------------------------
@@ -1196,14 +1923,160 @@ void CloudXRClientOVR::GetTrackingState(cxrVRTrackingState* trackingState)
     //  but that generates events and state changes the system isn't expecting.  so return for now.
     if (nullptr==trackingState) return; // TODO see if any issues not processing tracking.
 
-    // Unless the predicted time is used, tracking state will not be
-    // filtered and as a result view will be jumping all over the place.
-    const double predictedTimeS = ClientPredictionOffset == 0.0 ? 0.0 : GetTimeInSeconds() + ClientPredictionOffset;
-    // TODO: look into replacing this with mNextDisplayTime so tracking closer to real scanout
+    if (mWarmSuspended)
+    {
+        // no vr session to ask, hold the last pose and tell the server nobody's there.
+        TrackingSample sample;
+        mTrackingSnapshot.Load(sample);
+        *trackingState = sample.state;
+        trackingState->hmd.flags = 0;
+        trackingState->hmd.activityLevel = cxrDeviceActivityLevel_Standby;
+        return;
+    }
+
+    if (mTrackingThreadRunning)
+    {
+        // sampler thread owns all the vrapi work, we just hand out the latest copy.
+        TrackingSample sample;
+        mTrackingSnapshot.Load(sample);
+        *trackingState = sample.state;
+        mLastPoseSentS = sample.sampleTimeS;
+        if (sample.state.hmd.flags & cxrHmdTrackingFlags_HasRefresh)
+            mRefreshChanged = false;
+        return;
+    }
 
-    DoTracking(predictedTimeS);
-    if (trackingState != nullptr)
-        *trackingState = TrackingState;
+    std::lock_guard<std::mutex> lock(mTrackingMutex);
+    mLastPoseSentS = GetTimeInSeconds();
+    DoTracking(GetPredictedTrackingTime());
+    PublishTrackingSample();
+    *trackingState = TrackingState;
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+ovrRigidBodyPosef CloudXRClientOVR::GetLastHeadPose()
+{
+    TrackingSample sample;
+    if (mTrackingSnapshot.Load(sample))
+        return sample.headPose;
+
+    // nothing tracked yet.
+    ovrRigidBodyPosef identity = {};
+    identity.Pose.Orientation.w = 1.0f;
+    return identity;
+}
+
+//-----------------------------------------------------------------------------
+// Hands what the last DoTracking produced to the other threads, from whichever
+// thread ran it, with mTrackingMutex held.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::PublishTrackingSample()
+{
+    TrackingSample sample;
+    sample.state = TrackingState;
+    sample.headPose = mLastHeadPose;
+    sample.sampleTimeS = GetTimeInSeconds();
+    mTrackingSnapshot.Store(sample);
+}
+
+//-----------------------------------------------------------------------------
+// Sampler runs at a fixed rate, or once per display period at the vsync phase
+// when display-aligned.  Sampling INCLUDES controller input, so events are
+// generated at sampler rate rather than whenever the server polls.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::StartTrackingSampler()
+{
+    if (mTrackingThreadRunning)
+        return;
+
+    if (GOptions.mTrackingRate <= 0 && !GOptions.mTrackingDisplayAligned)
+        return; // inline sampling from the server callback.
+
+    mTrackingThreadRunning = true;
+    mTrackingThread = std::thread([this]() { TrackingSamplerLoop(); });
+
+    if (GOptions.mTrackingDisplayAligned)
+        CXR_LOGI("Tracking sampler started, aligned to display refresh.");
+    else
+        CXR_LOGI("Tracking sampler started at %0.1f hz.", GOptions.mTrackingRate);
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::StopTrackingSampler()
+{
+    if (!mTrackingThreadRunning)
+        return;
+
+    mTrackingThreadRunning = false;
+    if (mTrackingThread.joinable())
+        mTrackingThread.join();
+
+    CXR_LOGI("Tracking sampler stopped.");
+}
+
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::TrackingSamplerLoop()
+{
+    prctl(PR_SET_NAME, (long)"CXR Tracking", 0, 0, 0);
+
+    if (GOptions.mTrackingCpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(GOptions.mTrackingCpu, &cpus);
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+            CXR_LOGW("Unable to pin tracking sampler to cpu %d, error = %d", GOptions.mTrackingCpu, errno);
+        else
+            CXR_LOGI("Tracking sampler pinned to cpu %d", GOptions.mTrackingCpu);
+    }
+
+    const double fixedPeriodS = (GOptions.mTrackingRate > 0) ? 1.0 / GOptions.mTrackingRate : 0;
+    double nextTickS = GetTimeInSeconds();
+
+    while (mTrackingThreadRunning)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mTrackingMutex);
+            DoTracking(GetPredictedTrackingTime());
+            PublishTrackingSample();
+        }
+
+        // figure out when the next tick is due.
+        const double nowS = GetTimeInSeconds();
+        if (GOptions.mTrackingDisplayAligned)
+        {
+            // one sample per display period, phased one period ahead of next scanout.
+            const double periodS = 1.0 / std::fmax(mTargetDisplayRefresh, 1.0f);
+            const double displayTimeS = mNextDisplayTime;
+            if (displayTimeS <= 0)
+            {
+                nextTickS = nowS + periodS;
+            }
+            else
+            {
+                nextTickS = displayTimeS - periodS;
+                while (nextTickS <= nowS)
+                    nextTickS += periodS;
+            }
+        }
+        else
+        {
+            nextTickS += fixedPeriodS;
+            if (nextTickS < nowS) // fell behind, don't try to catch up in a burst.
+                nextTickS = nowS + fixedPeriodS;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = (time_t)nextTickS;
+        ts.tv_nsec = (long)((nextTickS - (double)ts.tv_sec) * 1e9);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -1282,6 +2155,26 @@ cxrDeviceDesc CloudXRClientOVR::GetDeviceDesc(float fovX, float fovY)
         }
     }
 
+    // the governor steps down from the rate we'd launch at, through the ones the display has.
+    if (GOptions.mQualityGovernor)
+    {
+        const int numRates = vrapi_GetSystemPropertyInt(&mJavaCtx, VRAPI_SYS_PROP_NUM_SUPPORTED_DISPLAY_REFRESH_RATES);
+        std::vector<float> supportedRates(numRates > 0 ? numRates : 0);
+        if (numRates > 0)
+            vrapi_GetSystemPropertyFloatArray(&mJavaCtx, VRAPI_SYS_PROP_SUPPORTED_DISPLAY_REFRESH_RATES,
+                                              supportedRates.data(), numRates);
+
+        mGovernorRefreshRates.clear();
+        mGovernorRefreshRates.push_back(mTargetDisplayRefresh);
+        for (float rate : supportedRates)
+        {
+            if (rate < mTargetDisplayRefresh - 1.0f)
+                mGovernorRefreshRates.push_back(rate);
+        }
+        std::sort(mGovernorRefreshRates.begin() + 1, mGovernorRefreshRates.end(), std::greater<float>());
+        mTargetDisplayRefresh = GovernedDisplayRefresh();
+    }
+
     if (mOvrSession == nullptr)
     {
         CXR_LOGE("OVR session is null, cannot continue.");
@@ -1327,11 +2220,13 @@ cxrDeviceDesc CloudXRClientOVR::GetDeviceDesc(float fovX, float fovY)
         desc.videoStreamDescs[i].width = width;
         desc.videoStreamDescs[i].height = height;
         desc.videoStreamDescs[i].fps = mTargetDisplayRefresh;
-        desc.videoStreamDescs[i].maxBitrate = GOptions.mMaxVideoBitrate;
+        desc.videoStreamDescs[i].maxBitrate = (uint32_t)(GOptions.mMaxVideoBitrate *
+                cxrQualityGovernor::BitrateScale(mQualityGovernor.Level(cxrQualityGovernor::Axis_Bandwidth)));
     }
     desc.stereoDisplay = true;
 
-    desc.maxResFactor = GOptions.mMaxResFactor;
+    desc.maxResFactor = std::fmax(0.5f, GOptions.mMaxResFactor *
+            cxrQualityGovernor::ResFactorScale(mQualityGovernor.Level(cxrQualityGovernor::Axis_Bandwidth)));
 
     const int maxWidth = (int)(desc.maxResFactor * (float)width);
     const int maxHeight = (int)(desc.maxResFactor * (float)height);
@@ -1348,7 +2243,9 @@ cxrDeviceDesc CloudXRClientOVR::GetDeviceDesc(float fovX, float fovY)
     desc.posePollFreq = 0;
     desc.disablePosePrediction = false;
     desc.angularVelocityInDeviceSpace = false;
-    desc.foveatedScaleFactor = (GOptions.mFoveation < 100) ? GOptions.mFoveation : 0;
+    const uint32_t foveation = cxrQualityGovernor::Foveation(GOptions.mFoveation,
+            mQualityGovernor.Level(cxrQualityGovernor::Axis_Latency));
+    desc.foveatedScaleFactor = (foveation < 100) ? foveation : 0;
 
     const float halfFOVTanX = tanf(VRAPI_PI/360.f * fovX);
     const float halfFOVTanY = tanf(VRAPI_PI/360.f * fovY);
@@ -1371,20 +2268,72 @@ cxrDeviceDesc CloudXRClientOVR::GetDeviceDesc(float fovX, float fovY)
 //-----------------------------------------------------------------------------
 void CloudXRClientOVR::RecreateSwapchain(uint32_t width, uint32_t height, uint32_t eye)
 {
-    // TODO: this log should likely be Warning level, as this is expensive and we should
-    //   see clearly in log when it happens.  Don't think it needs to be Error, but will for now.
-    CXR_LOGE("Recreating swapchain for eye%d: %d x %d (was %d x %d)",
-          eye, width, height, EyeWidth[eye], EyeHeight[eye]);
+    // with an array chain both eyes live in the same images, so it has to
+    // hold the larger of the two and the other eye moves along with us.
+    const bool arrayChain = GOptions.mArraySwapchain;
+    const uint32_t otherEye = 1 - eye;
+    SwapChainPool& pool = mSwapChainPools[arrayChain ? 0 : eye];
+    const uint32_t needWidth = arrayChain ? std::max(width, EyeWidth[otherEye]) : width;
+    const uint32_t needHeight = arrayChain ? std::max(height, EyeHeight[otherEye]) : height;
+
+    // the pool only allocates if nothing it holds is big enough, otherwise we
+    // just render to a smaller or larger sub-rect of a chain we already have.
+    const uint32_t allocations = pool.GetAllocationCount();
+    const SwapChainPool::Entry* entry = pool.Acquire(needWidth, needHeight);
+    if (pool.GetAllocationCount() != allocations)
+        mFramebuffersStale = true; // a chain may have been evicted, see SetupFramebuffer.
+    if (entry == nullptr)
+    {
+        // the pool may have destroyed the chain we were using to make room, so let go
+        // of it.  Render skips the eye, and the size mismatch retries on the next frame.
+        CXR_LOGE("No swapchain available for eye%d: %d x %d", eye, width, height);
+        SwapChains[eye] = nullptr;
+        EyeWidth[eye] = EyeHeight[eye] = 0;
+        if (arrayChain)
+        {
+            SwapChains[otherEye] = nullptr;
+            EyeWidth[otherEye] = EyeHeight[otherEye] = 0;
+        }
+        mHaveLastFrame = false;
+        return;
+    }
 
-    if (SwapChains[eye])
-        vrapi_DestroyTextureSwapChain(SwapChains[eye]);
+    CXR_LOGI("Resizing eye%d: %d x %d (was %d x %d) in %d x %d swapchain",
+          eye, width, height, EyeWidth[eye], EyeHeight[eye], entry->width, entry->height);
 
-    SwapChains[eye] = vrapi_CreateTextureSwapChain2(VRAPI_TEXTURE_TYPE_2D,
-                                                    VRAPI_TEXTURE_FORMAT_8888_sRGB,
-                                                    width, height,
-                                                    1, SwapChainLen);
     EyeWidth[eye] = width;
     EyeHeight[eye] = height;
+    SetEyeSwapchain(eye, *entry);
+    if (arrayChain)
+        SetEyeSwapchain(otherEye, *entry);
+
+    // the last images were rendered to the old rect (or chain), nothing left to reproject.
+    mHaveLastFrame = false;
+}
+
+//-----------------------------------------------------------------------------
+// Points an eye at a pooled chain, and scales its layer mapping to the
+// EyeWidth x EyeHeight sub-rect we render to.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::SetEyeSwapchain(uint32_t eye, const SwapChainPool::Entry& entry)
+{
+    if (entry.chain != SwapChains[eye])
+    {
+        SwapChains[eye] = entry.chain;
+        SwapChainIndex[eye] = 0;
+    }
+
+    // tan angles map to 0..1 over the whole texture, scale that down to the part we fill.
+    // we render bottom-left aligned, so there's no offset to apply.
+    const float scaleX = (float)EyeWidth[eye] / (float)entry.width;
+    const float scaleY = (float)EyeHeight[eye] / (float)entry.height;
+    EyeTexCoords[eye] = TexCoordsFromTanAngles;
+    for (int col = 0; col < 4; ++col)
+    {
+        EyeTexCoords[eye].M[0][col] *= scaleX;
+        EyeTexCoords[eye].M[1][col] *= scaleY;
+    }
+    EyeTextureRect[eye] = { 0.0f, 0.0f, scaleX, scaleY };
 }
 
 //-----------------------------------------------------------------------------
@@ -1398,42 +2347,22 @@ void CloudXRClientOVR::TriggerHaptic(
     if (haptic.seconds <= 0)
         return;
 
-    uint32_t deviceIndex = 0;
-    ovrInputCapabilityHeader capsHeader;
-    while (vrapi_EnumerateInputDevices(mOvrSession, deviceIndex, &capsHeader) >= 0)
-    {
-        ++deviceIndex;
-
-        if (capsHeader.Type == ovrControllerType_TrackedRemote)
-        {
-            ovrInputTrackedRemoteCapabilities remoteCaps;
-            remoteCaps.Header = capsHeader;
-            vrapi_GetInputDeviceCapabilities(mOvrSession, &remoteCaps.Header);
-
-            // now we simply compare the physical controller ID.
-            if (haptic.deviceID != capsHeader.DeviceID)
-                continue;
-
-            // and of course, sanity check this device HAS haptic support...
-            if (0 == (remoteCaps.ControllerCapabilities & ovrControllerCaps_HasBufferedHapticVibration))
-                continue;
-
-            ovrHapticBuffer hapticBuffer;
-            hapticBuffer.BufferTime = GetTimeInSeconds() + 0.03; // TODO: use mNextDisplayTime?
-            hapticBuffer.NumSamples = remoteCaps.HapticSamplesMax;
-            hapticBuffer.HapticBuffer =
-                    reinterpret_cast<uint8_t*>(alloca(remoteCaps.HapticSamplesMax));
-            hapticBuffer.Terminated = true;
+    // now we simply compare the physical controller ID.
+    ControllerRegistry::Controller ctl;
+    uint32_t handIndex;
+    if (!mControllers.FindByDeviceID((ovrDeviceID)haptic.deviceID, ctl, &handIndex))
+        return;
 
-            for (uint32_t i = 0; i < hapticBuffer.NumSamples; i++)
-            {
-                hapticBuffer.HapticBuffer[i] =
-                        static_cast<uint8_t>(haptic.amplitude*255.f);
-            }
+    // and of course, sanity check this device HAS haptic support...
+    if (0 == ctl.hapticSamplesMax)
+        return;
 
-            vrapi_SetHapticVibrationBuffer(mOvrSession, capsHeader.DeviceID, &hapticBuffer);
-        }
-    }
+    // the pulse belongs with the frame being rendered now, so start it when that
+    // frame reaches the display.  buffers are built and submitted on the worker.
+    const double nowS = GetTimeInSeconds();
+    const double displayTimeS = mNextDisplayTime;
+    mHaptics.Enqueue(handIndex, (displayTimeS > nowS) ? displayTimeS : nowS,
+            haptic.seconds, haptic.frequency, haptic.amplitude);
 }
 
 
@@ -1442,14 +2371,14 @@ void CloudXRClientOVR::TriggerHaptic(
 //-----------------------------------------------------------------------------
 cxrBool CloudXRClientOVR::RenderAudio(const cxrAudioFrame *audioFrame)
 {
-    if (!playbackStream)
+    if (!mAudioReady.load(std::memory_order_acquire))
     {
         return cxrFalse;
     }
 
-    const uint32_t timeout = audioFrame->streamSizeBytes / CXR_AUDIO_BYTES_PER_MS;
-    const uint32_t numFrames = timeout * CXR_AUDIO_SAMPLING_RATE / 1000;
-    playbackStream->write(audioFrame->streamBuffer, numFrames, timeout * oboe::kNanosPerMillisecond);
+    // never blocks, a packet that doesn't fit is dropped and counted.
+    const uint32_t numFrames = audioFrame->streamSizeBytes / (CXR_AUDIO_CHANNEL_COUNT * CXR_AUDIO_SAMPLE_SIZE);
+    mAudioPlayback.Write(audioFrame->streamBuffer, numFrames, (int64_t)GetTimeInNS());
 
     return cxrTrue;
 }
@@ -1466,6 +2395,7 @@ void CloudXRClientOVR::SubmitLayers(const ovrLayerHeader2* layers[], int layerCo
     frameDesc.SwapInterval = 1;
     frameDesc.FrameIndex = mFrameCounter;
     frameDesc.DisplayTime = mNextDisplayTime;
+    ScopedTrace trace("vrapi_SubmitFrame2");
     vrapi_SubmitFrame2(mOvrSession, &frameDesc);
 }
 
@@ -1510,46 +2440,85 @@ void CloudXRClientOVR::Render()
 
     ovrLayerProjection2 worldLayer = vrapi_DefaultLayerProjection2();
 
-    worldLayer.HeadPose = mLastHeadPose;
+    worldLayer.HeadPose = GetLastHeadPose();
     worldLayer.Header.Flags |= VRAPI_FRAME_LAYER_FLAG_CHROMATIC_ABERRATION_CORRECTION;
 
-#if later
-    if (GOptions.mTestLatency)
+    // local latency test: the sampler saw the edge, this frame is the one that shows it.
+    double latencyInputS = -1.0;
+    if (GOptions.mTestLatency && !Receiver)
     {
-        // TODO: for this non-connected test mode, or any other local UX, we currently have
-        //  to manually call call GetTrackingState(null) to update input and hmd status -- as
-        //  current code only updates state during client callback when connected to server.
-        //  Future improvement would be to run update in a separate thread, and be able to copy
-        //  out those results for the callback or here.
-        if (testButtonPressed)
-            mBGColor = 0xFFFFFFFF;
-        else
-            mBGColor = mDefaultBGColor;
+        bool pressed;
+        double edgeS;
+        if (mLatencyTest.TakeInputEdge(pressed, edgeS))
+        {
+            mBGColor = pressed ? 0xFFFFFFFF : mDefaultBGColor;
+            latencyInputS = edgeS;
+        }
     }
-#endif
+    double latencyPoseS = -1.0;
+    double latencyLatchS = 0;
 
     // Fetch a CloudXR frame
     cxrFramesLatched framesLatched;
-    const uint32_t timeoutMs = 500;
+    const bool reproject = (GOptions.mLatchMode == CloudXR::LatchMode_Reproject);
+    const uint32_t timeoutMs = reproject ? GetLatchBudgetMs() : 500;
     bool frameValid = false;
 
+    FrameTimingRecord timing = {};
+    timing.frameIndex = mFrameCounter;
+    timing.displayTimeS = mNextDisplayTime;
+    timing.gpuEyeMs[0] = timing.gpuEyeMs[1] = -1.0f;
+
+    // a GPU that's FramesInFlight behind is waited for here, ahead of the latch,
+    // rather than somewhere in the driver after it, so what we latch is fresher.
+    EGLHelper::Handle& fence = mFrameFences[mFrameCounter % FramesInFlight];
+    if (fence)
+    {
+        const double waitStartS = GetTimeInSeconds();
+        EGLHelper::WaitFence(fence, true);
+        EGLHelper::ReleaseFence(fence);
+        fence = 0;
+        timing.fenceWaitMs = (float)((GetTimeInSeconds() - waitStartS) * 1000.0);
+    }
+
+    GpuTimer::Result gpuResult;
+    float gpuWorkMs = -1.0f; // a few frames old, but it's what the GPU really spent.
+    if (mGpuTimer.BeginFrame(mFrameCounter, gpuResult))
+        gpuWorkMs = AddGpuTiming(gpuResult);
+
+    timing.latchStartS = GetTimeInSeconds();
+
     if (Receiver)
     {
         if (mClientState == cxrClientState_StreamingSessionInProgress)
         {
-            cxrError frameErr = cxrLatchFrame(Receiver, &framesLatched,
-                                            cxrFrameMask_All, timeoutMs);
+            cxrError frameErr;
+            {
+                ScopedTrace trace("cxrLatchFrame");
+                frameErr = cxrLatchFrame(Receiver, &framesLatched,
+                                         cxrFrameMask_All, timeoutMs);
+            }
             frameValid = (frameErr == cxrError_Success);
+            const double latchEndS = GetTimeInSeconds();
+            if (frameValid)
+                GStartup.Mark(StartupTimeline::Phase_FirstFrameLatched);
+            timing.latchWaitMs = (float)((latchEndS - timing.latchStartS) * 1000.0);
+            timing.poseAgeMs = (float)((latchEndS - mLastPoseSentS) * 1000.0);
+            UpdatePredictionLatency(latchEndS - timing.latchStartS);
             if (!frameValid)
             {
                 if (frameErr == cxrError_Frame_Not_Ready)
                 {
-                    CXR_LOGI("LatchFrame failed, frame not ready for %d ms", timeoutMs);
+                    // expected regularly when reprojecting, those get counted instead.
+                    if (!reproject)
+                        CXR_LOGI("LatchFrame failed, frame not ready for %d ms", timeoutMs);
                 }
                 else if (frameErr == cxrError_Not_Connected)
                 {
+                    // the state callback reports the disconnect too, and the main loop
+                    // decides between failing over and exiting, so just hurry it along.
                     CXR_LOGE("LatchFrame failed, receiver no longer connected.");
-                    RequestExit();
+                    WakeMainLoop();
                 }
                 else
                 {
@@ -1559,45 +2528,100 @@ void CloudXRClientOVR::Render()
         }
     }
 
+    // no new frame in time: hand the compositor the last one again, with the pose
+    // it was rendered for, and timewarp reprojects it to the current head pose.
+    const bool repeatFrame = reproject && !frameValid && mHaveLastFrame &&
+            mClientState == cxrClientState_StreamingSessionInProgress;
+    if (repeatFrame)
+    {
+        worldLayer.HeadPose = mLastFrameHeadPose;
+        mRepeatedFrames++;
+    }
+
+    timing.kind = frameValid ? FrameKind_Streamed : (repeatFrame ? FrameKind_Repeated : FrameKind_Background);
+    const double blitStartS = GetTimeInSeconds();
+
+    bool eyeMissing = false; // no swapchain to draw into, a black layer goes out instead.
     for (int eye = 0; eye < VRAPI_FRAME_LAYER_EYE_MAX; eye++)
     {
-        // if valid frame and the size has changed, update our buffers to match.
-        // TODO: we might want to use a frame subrect if the buffer is BIGGER and we're shrinking,
-        //  just to avoid allocation thrash and hiccups due to it.
+        if (repeatFrame)
+        {
+            worldLayer.Textures[eye].ColorSwapChain = SwapChains[eye];
+            worldLayer.Textures[eye].SwapChainIndex = SwapChainIndex[eye];
+            worldLayer.Textures[eye].TexCoordsFromTanAngles = EyeTexCoords[eye];
+            worldLayer.Textures[eye].TextureRect = EyeTextureRect[eye];
+            continue;
+        }
+
+        // if valid frame and the size has changed, move to a sub-rect (or pooled chain) that matches.
         cxrVideoFrame &vf = framesLatched.frames[eye];
         if (frameValid && (vf.widthFinal != EyeWidth[eye] || vf.heightFinal != EyeHeight[eye]) )
             RecreateSwapchain(vf.widthFinal, vf.heightFinal, eye);
+        if (SwapChains[eye] == nullptr)
+        {
+            eyeMissing = true;
+            continue;
+        }
 
+        // advance only when we write a new image, so a repeated image is never the next one drawn into.
         const uint32_t swapChainLength = vrapi_GetTextureSwapChainLength(SwapChains[eye]);
-        const int swapChainIndex = mFrameCounter % swapChainLength;
+        const int swapChainIndex = (SwapChainIndex[eye] + 1) % swapChainLength;
+        SwapChainIndex[eye] = swapChainIndex;
         const GLuint colorTexture = vrapi_GetTextureSwapChainHandle(SwapChains[eye], swapChainIndex);
 
         if (SetupFramebuffer(colorTexture, eye))
         {
+            mGpuTimer.Begin(eye);
             if (frameValid)
             {
                 // blit streamed frame into the world layer
+                ScopedTrace trace("cxrBlitFrame");
                 cxrBlitFrame(Receiver, &framesLatched, 1<<eye);
             }
             else
             {
                 FillBackground();
             }
+            mGpuTimer.End(eye);
 
             // NOTE: this is where a given app might render UI/overlays
         }
 
         worldLayer.Textures[eye].ColorSwapChain = SwapChains[eye];
         worldLayer.Textures[eye].SwapChainIndex = swapChainIndex;
-        worldLayer.Textures[eye].TexCoordsFromTanAngles = TexCoordsFromTanAngles;
+        worldLayer.Textures[eye].TexCoordsFromTanAngles = EyeTexCoords[eye];
+        worldLayer.Textures[eye].TextureRect = EyeTextureRect[eye];
     }
 
+    // flushed now, so the GPU is working on the blits while we release the frame
+    // and get to submit, instead of starting only once submit flushes for us.
+    if (!repeatFrame)
+    {
+        fence = EGLHelper::PushFence();
+        glFlush();
+    }
+    timing.blitMs = (float)((GetTimeInSeconds() - blitStartS) * 1000.0);
+
+    UpdateStatsHud(timing);
+
     if (frameValid) // means we had a receiver AND latched frame.
     {
+        if (GOptions.mPredictionMode == CloudXR::PredictionMode_Adaptive)
+            UpdatePredictionError(framesLatched.poseMatrix);
+
         worldLayer.HeadPose.Pose.Orientation = cxrToQuaternion(framesLatched.poseMatrix);
         worldLayer.HeadPose.Pose.Position = cxrGetTranslation(framesLatched.poseMatrix);
 
+        if (GOptions.mTestLatency)
+        {
+            const ovrQuatf& q = worldLayer.HeadPose.Pose.Orientation;
+            const cxrQuaternion rotation = { q.w, q.x, q.y, q.z };
+            latencyPoseS = mLatencyTest.FindPoseSample(rotation, cxrConvert(worldLayer.HeadPose.Pose.Position));
+            latencyLatchS = timing.latchStartS + timing.latchWaitMs * 0.001;
+        }
+
         cxrReleaseFrame(Receiver, &framesLatched);
+        mLastFrameHeadPose = worldLayer.HeadPose;
 
         // Log connection stats every 3 seconds
         const int STATS_INTERVAL_SEC = 3;
@@ -1647,16 +2671,113 @@ void CloudXRClientOVR::Render()
                 }
             }
 
-            CXR_LOGI("%s    %s    %s", statsString, qualityString, reasonString);
+            char predictionString[64] = { 0 };
+            if (GOptions.mPredictionMode == CloudXR::PredictionMode_Adaptive)
+            {
+                snprintf(predictionString, 64, "Prediction (ms): %5.1f    Residual (deg): %5.2f",
+                         mPredictionHorizon * 1000.0f, mPredictionErrorDeg);
+            }
+
+            char repeatString[64] = { 0 };
+            if (reproject)
+            {
+                const double nowS = GetTimeInSeconds();
+                const double elapsedS = nowS - mLastStatsTime;
+                if (mLastStatsTime > 0 && elapsedS > 0)
+                    snprintf(repeatString, 64, "Repeated (fps): %4.1f", mRepeatedFrames / elapsedS);
+                mLastStatsTime = nowS;
+                mRepeatedFrames = 0;
+            }
+
+            char gpuString[64] = { 0 };
+            if (mGpuMsCount > 0)
+            {
+                snprintf(gpuString, 64, "GPU blit (ms): %4.2f avg, %4.2f max", mGpuMsSum / mGpuMsCount, mGpuMsMax);
+                mGpuMsSum = mGpuMsMax = 0;
+                mGpuMsCount = 0;
+            }
+
+            // optional parts are left out when empty, so the line has no runs of blank columns.
+            std::string statsLine = statsString;
+            for (const char* part : { qualityString, reasonString, predictionString, repeatString, gpuString })
+            {
+                if (part[0] == 0)
+                    continue;
+                statsLine += "    ";
+                statsLine += part;
+            }
+            CXR_LOGI("%s", statsLine.c_str());
+
+            // audio only gets a line when it glitched since the last one.
+            if (playbackStream)
+            {
+                cxrAudioJitterBuffer::Stats audio;
+                mAudioPlayback.GetStats(audio);
+                if (audio.underruns != mAudioStatsLast.underruns || audio.overruns != mAudioStatsLast.overruns)
+                {
+                    CXR_LOGW("Audio: %u underruns, %u overruns since last stats, target %.1f ms, jitter %.1f ms",
+                             audio.underruns - mAudioStatsLast.underruns, audio.overruns - mAudioStatsLast.overruns,
+                             audio.targetFrames * 1000.0f / CXR_AUDIO_SAMPLING_RATE, audio.jitterMs);
+                }
+                mAudioStatsLast = audio;
+            }
             mFramesUntilStats = (int)mStats.framesPerSecond * STATS_INTERVAL_SEC;
         }
     }
 
-    const ovrLayerHeader2* layers[] = { &worldLayer.Header };
-    SubmitLayers(layers, 1, static_cast<ovrFrameFlags>(0));
+    // only a streamed image is worth repeating, not a background fill.
+    mHaveLastFrame = (frameValid || repeatFrame) && !eyeMissing;
+
+    // the hud is its own layer, the compositor draws it over the world.
+    ovrLayerProjection2 blackLayer = vrapi_DefaultLayerBlackProjection2();
+    blackLayer.Header.Flags |= VRAPI_FRAME_LAYER_FLAG_INHIBIT_SRGB_FRAMEBUFFER;
+    const ovrLayerHeader2* layers[2] = { eyeMissing ? &blackLayer.Header : &worldLayer.Header };
+    int layerCount = 1;
+    if (const ovrLayerHeader2* hud = mStatsHud.Layer())
+        layers[layerCount++] = hud;
+    const double submitStartS = GetTimeInSeconds();
+    SubmitLayers(layers, layerCount, static_cast<ovrFrameFlags>(0));
+    timing.submitMs = (float)((GetTimeInSeconds() - submitStartS) * 1000.0);
+    if (frameValid)
+        GStartup.Mark(StartupTimeline::Phase_FirstFrameSubmitted);
+    mFrameTimings.Push(timing);
+
+    if (GOptions.mTestLatency)
+    {
+        const double submitS = submitStartS + timing.submitMs * 0.001;
+        if (latencyInputS >= 0)
+            mLatencyTest.AddInputFrame(latencyInputS, submitS, mNextDisplayTime);
+        if (latencyPoseS >= 0)
+            mLatencyTest.AddPoseFrame(latencyPoseS, latencyLatchS, submitS, mNextDisplayTime);
+        if (submitS >= mLatencyNextLogS && mLatencyTest.Samples() > 0)
+        {
+            mLatencyTest.LogSummary();
+            mLatencyNextLogS = submitS + 10.0;
+        }
+    }
+
+    // blit and background fill are the GPU work that's ours, submit mostly waits on pacing.
+    // without the timer extension the blit's CPU time is the only measure there is,
+    // with it a frame whose result didn't come back counts for misses only.
+    if (GOptions.mClockGovernor)
+        mClockGovernor.AddFrame(timing.displayTimeS, 1.0 / std::fmax(mTargetDisplayRefresh, 1.0f),
+                                mGpuTimer.IsAvailable() ? gpuWorkMs : timing.blitMs);
 }
 
 
+//-----------------------------------------------------------------------------
+// How long we can block in cxrLatchFrame and still get the frame submitted in
+// time for mNextDisplayTime.  The compositor wants it about a display period
+// ahead of scanout, and we hold back a little for blit and submit.
+//-----------------------------------------------------------------------------
+uint32_t CloudXRClientOVR::GetLatchBudgetMs()
+{
+    const double periodS = 1.0 / std::fmax(mTargetDisplayRefresh, 1.0f);
+    const double leftS = mNextDisplayTime - GetTimeInSeconds() - periodS - LatchSubmitMargin;
+    const double budgetS = std::fmin(std::fmax(leftS, 0.001), periodS);
+    return (uint32_t)ceil(budgetS * 1000.0);
+}
+
 //-----------------------------------------------------------------------------
 //
 //-----------------------------------------------------------------------------
@@ -1692,18 +2813,64 @@ void CloudXRClientOVR::AppResumed()
 
     // get controller state and HMD state up-front now.
     DetectControllers();
+    mHaptics.Start(mOvrSession, &mControllers);
     // clear input history.  this might be messy if we paused in
     // different state, but can't trust leaving and coming back
     // and guaranteeing input historical status is 'static'.
-    memset(mLastInputState, 0, sizeof(mLastInputState));
+    for (uint32_t handIndex = 0; handIndex < MAX_CONTROLLERS; handIndex++)
+        ResetInputState(handIndex);
+
+    if (mWarmSuspended)
+    {
+        // device desc, swapchains and receiver are all still good, the new vr
+        // session just needs our rate and the tracking and audio restarted.
+        const double resumeStartS = GetTimeInSeconds();
+        vrapi_SetDisplayRefreshRate(mOvrSession, mTargetDisplayRefresh);
+        if (playbackStream)
+        {
+            // nothing was written while suspended, start from empty and prime.
+            mAudioPlayback.Flush();
+            mAudioReady.store(true, std::memory_order_release);
+            playbackStream->requestStart();
+        }
+        if (recordingStream)
+            recordingStream->requestStart();
+        mWarmSuspended = false;
+        StartTrackingSampler();
+        CXR_LOGI("Warm resume after %.1f s suspended, took %.1f ms.", resumeStartS - mWarmSuspendStartS,
+                 (GetTimeInSeconds() - resumeStartS) * 1000.0);
+
+        mWasPaused = mIsPaused;
+        return;
+    }
+
     mDeviceDesc = GetDeviceDesc(EyeFovDegreesX, EyeFovDegreesY);
+    GStartup.Mark(StartupTimeline::Phase_DeviceDescReady);
 
-    // create the initial swapchain buffers based on HMD specs.
+    // create the initial swapchain buffers based on HMD specs, at the largest size
+    // the server may scale up to, so resolution changes fit without reallocating.
     for (int eye = 0; eye < VRAPI_FRAME_LAYER_EYE_MAX; eye++)
-        RecreateSwapchain(mDeviceDesc.videoStreamDescs[eye].width, mDeviceDesc.videoStreamDescs[eye].height, eye);
+    {
+        const cxrClientVideoStreamDesc& stream = mDeviceDesc.videoStreamDescs[eye];
+        mSwapChainPools[eye].SetTextureType(GOptions.mArraySwapchain ? VRAPI_TEXTURE_TYPE_2D_ARRAY : VRAPI_TEXTURE_TYPE_2D);
+        mSwapChainPools[eye].SetAllocationSize((uint32_t)(mDeviceDesc.maxResFactor * stream.width),
+                                               (uint32_t)(mDeviceDesc.maxResFactor * stream.height));
+        RecreateSwapchain(stream.width, stream.height, eye);
+    }
+    GStartup.Mark(StartupTimeline::Phase_SwapchainsReady);
+
+    // the local latency test has nothing to connect to, it renders the background
+    // and flips it on input the sampler polls.
+    if (GOptions.mTestLatency && GOptions.mServerIP.empty())
+    {
+        StartTrackingSampler();
+        mRenderState = RenderState_Running;
+        mWasPaused = mIsPaused;
+        return;
+    }
 
     // TODO: move this to a once-per-frame check like wvr sample does in its UpdatePauseLogic fn.
-    if (!Receiver && mReadyToConnect &&
+    if (!Receiver && mReadyToConnect && mServerSelected &&
         CreateReceiver() != cxrError_Success)
     {
         CXR_LOGE("Failed to create the receiver, exiting...");
@@ -1733,11 +2900,40 @@ void CloudXRClientOVR::AppPaused() {
     //  rendering actively while we're pausing...
     CXR_LOGI("App Paused");
 
-    for (int i = 0; i < NumEyes; ++i)
+    // NOTE: render thread is already stopped, and took its FBOs with it.
+    //  they get rebuilt against whatever swapchains are there on resume.
+    mFramebuffersStale = true;
+
+    if (mWarmSuspended)
     {
-        glDeleteFramebuffers(1, &Framebuffers[i]);
-        Framebuffers[i] = 0;
+        // swapchains aren't tied to the vr session, and the receiver keeps going
+        // on held poses.  audio is only paused, and RenderAudio drops the server's
+        // audio meanwhile rather than filling a buffer nobody reads.
+        mAudioReady.store(false, std::memory_order_release);
+        if (playbackStream)
+            playbackStream->requestStop();
+        if (recordingStream)
+            recordingStream->requestStop();
+        mWarmSuspendStartS = GetTimeInSeconds();
+        CXR_LOGI("Warm suspend, keeping the session for up to %u s.", GOptions.mWarmSuspendS);
     }
+    else
+    {
+        ReleaseStreamingResources();
+    }
+
+    // now match variable state
+    mWasPaused = mIsPaused;
+}
+
+//-----------------------------------------------------------------------------
+// Everything a resume would otherwise have to rebuild: the receiver, its audio
+// streams and the swapchains.  Main thread, with the render thread stopped.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::ReleaseStreamingResources()
+{
+    mWarmSuspended = false;
+    mFramebuffersStale = true;
 
     if (Receiver)
     {
@@ -1750,20 +2946,320 @@ void CloudXRClientOVR::AppPaused() {
         }
     }
 
+    for (auto& pool : mSwapChainPools)
+        pool.Release();
     for (auto& swapChain : SwapChains)
-    {
-        if (swapChain != nullptr)
-            vrapi_DestroyTextureSwapChain(swapChain);
         swapChain = nullptr;
-    }
 
     EyeWidth[0] = EyeWidth[1] = EyeHeight[0] = EyeHeight[1] = 0;
     TrackingState = {};
+}
 
-    // now match variable state
-    mWasPaused = mIsPaused;
+//-----------------------------------------------------------------------------
+// A warm suspend that runs past its timeout, or loses the session in a way
+// UpdateClientState didn't already handle, gets the full teardown it skipped.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdateWarmSuspend()
+{
+    if (!mWarmSuspended)
+        return;
+
+    const double suspendedS = GetTimeInSeconds() - mWarmSuspendStartS;
+    const bool lost = (mClientState != cxrClientState_StreamingSessionInProgress);
+    if (!lost && suspendedS < GOptions.mWarmSuspendS)
+        return;
+
+    CXR_LOGI("Warm suspend ending after %.1f s (%s), releasing the session.",
+             suspendedS, lost ? "session lost" : "timed out");
+    ReleaseStreamingResources();
 }
 
+//-----------------------------------------------------------------------------
+// With one server there's nothing to pick.  With several, they're probed while
+// the loading screen is up, and the connect AppResumed held back happens here.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdateServerSelection()
+{
+    if (mServerSelected || !mReadyToConnect)
+        return;
+
+    if (GOptions.mServerCandidates.size() < 2)
+    {
+        mServerRanking = { GOptions.mServerIP };
+        mServerSelected = true;
+        return;
+    }
+
+    if (!mServerProbe.IsRunning())
+    {
+        mServerProbe.Start(GOptions.mServerCandidates, GOptions.mServerProbes);
+        return;
+    }
+    if (!mServerProbe.IsDone())
+        return;
+
+    mServerProbe.Stop();
+    const std::vector<cxrServerProbe::Result> ranked = mServerProbe.Ranked();
+    mServerRanking.clear();
+    for (const auto& result : ranked)
+    {
+        CXR_LOGI("Server %s: rtt %.1f ms (min %.1f), jitter %.1f ms, %u/%u probes failed%s.",
+                 result.address.c_str(), result.rttMs, result.minRttMs, result.jitterMs,
+                 result.failed, result.sent, result.Reachable() ? "" : ", unreachable");
+        // unreachable ones are only worth trying if nothing answered at all.
+        if (result.Reachable() || !ranked[0].Reachable())
+            mServerRanking.push_back(result.address);
+    }
+    mServerRank = 0;
+    GOptions.mServerIP = mServerRanking[0];
+    mServerSelected = true;
+    GStartup.Mark(StartupTimeline::Phase_ServerSelected);
+    CXR_LOGI("Selected server %s, %zu candidates left to fail over to.",
+             GOptions.mServerIP.c_str(), mServerRanking.size() - 1);
+
+    // a resume that already happened skipped the connect, waiting on us.
+    if (mOvrSession != nullptr && !mIsPaused && !Receiver && mClientState != cxrClientState_Exiting &&
+        CreateReceiver() != cxrError_Success && !FailoverToNextServer())
+    {
+        CXR_LOGE("Failed to create the receiver, exiting...");
+        RequestExit();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Drops a lost or unreachable server for the next in the ranking, without
+// leaving vr mode.  Returns false when there is none left.
+//-----------------------------------------------------------------------------
+bool CloudXRClientOVR::FailoverToNextServer()
+{
+    while (mServerRank + 1 < mServerRanking.size())
+    {
+        const std::string lost = GOptions.mServerIP;
+        GOptions.mServerIP = mServerRanking[++mServerRank];
+        CXR_LOGW("Server %s failed, failing over to %s (%u of %zu).", lost.c_str(), GOptions.mServerIP.c_str(),
+                 mServerRank + 1, mServerRanking.size());
+
+        if (mWarmSuspended)
+        {
+            // nothing is rendering, the resume connects to the new server as usual.
+            ReleaseStreamingResources();
+            return true;
+        }
+
+        // the render thread latches from the receiver, so it stops while we swap it.
+        StopRenderThread();
+        if (Receiver)
+            TeardownReceiver();
+        mClientState = cxrClientState_ReadyToConnect;
+        mRenderState = RenderState_Loading;
+        mFramebuffersStale = true;
+        mHaveLastFrame = false;
+
+        if (mOvrSession == nullptr || mIsPaused)
+            return true; // resume does the connect.
+
+        if (CreateReceiver() == cxrError_Success)
+        {
+            StartRenderThread();
+            return true;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// What it takes for a control channel change to an option to reach the running
+// client.  Anything not listed only goes into the device desc or receiver setup,
+// and takes a 'reconnect'.
+//-----------------------------------------------------------------------------
+typedef enum
+{
+    LiveApply_Reconnect = 0,
+    LiveApply_Immediate,    // main thread only, or atomic where another thread reads it.
+    LiveApply_Log,
+    LiveApply_Sampler,      // input filters and tracking sampler, rebuilt together.
+    LiveApply_Clocks,
+} LiveApply;
+
+static const std::unordered_map<std::string, LiveApply> s_liveOptions =
+{
+    { "prediction-mode", LiveApply_Immediate }, { "pm", LiveApply_Immediate },
+    { "latch-mode", LiveApply_Immediate }, { "lm", LiveApply_Immediate },
+    { "quality-governor", LiveApply_Immediate }, { "qg", LiveApply_Immediate },
+    { "frame-timing-csv", LiveApply_Immediate }, { "ftc", LiveApply_Immediate },
+    { "stats-hud", LiveApply_Immediate }, { "hud", LiveApply_Immediate },
+    { "warm-suspend", LiveApply_Immediate }, { "ws", LiveApply_Immediate },
+    { "log-level", LiveApply_Log }, { "ll", LiveApply_Log },
+    { "log-verbose", LiveApply_Log }, { "v", LiveApply_Log },
+    { "log-quiet", LiveApply_Log }, { "q", LiveApply_Log },
+    { "log-category", LiveApply_Log }, { "lc", LiveApply_Log },
+    { "log-privacy-disable", LiveApply_Log }, { "p", LiveApply_Log },
+    { "input-deadband", LiveApply_Sampler }, { "idb", LiveApply_Sampler },
+    { "input-quantize", LiveApply_Sampler }, { "iq", LiveApply_Sampler },
+    { "input-axis-rate", LiveApply_Sampler }, { "iar", LiveApply_Sampler },
+    { "tracking-rate", LiveApply_Sampler }, { "tr", LiveApply_Sampler },
+    { "tracking-cpu", LiveApply_Sampler }, { "tcpu", LiveApply_Sampler },
+    { "clock-governor", LiveApply_Clocks }, { "cg", LiveApply_Clocks },
+    { "cpu-levels", LiveApply_Clocks }, { "cpul", LiveApply_Clocks },
+    { "gpu-levels", LiveApply_Clocks }, { "gpul", LiveApply_Clocks },
+};
+
+//-----------------------------------------------------------------------------
+// Started once options name a socket.  Commands are handled here on the main
+// thread, the same one that owns the state they change.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::UpdateControlChannel()
+{
+    if (!mControlChannelTried && !GOptions.mControlSocket.empty())
+    {
+        mControlChannelTried = true;
+        mControlChannel.Start(GOptions.mControlSocket, [this]() { WakeMainLoop(); });
+    }
+
+    std::string line;
+    while (mControlChannel.Pop(line))
+        HandleControlCommand(line);
+}
+
+//-----------------------------------------------------------------------------
+// A line is either 'reconnect', or options exactly as on the command line.
+// Each option goes through its AddOption handler, then whatever the applied
+// ones need is done once, and the reply says where each one landed.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::HandleControlCommand(const std::string& line)
+{
+    CXR_LOGI("Control command: %s", line.c_str());
+
+    if (line == "reconnect")
+    {
+        if (!Receiver || mOvrSession == nullptr || mIsPaused || mWarmSuspended)
+        {
+            mControlChannel.Reply("error: not connected, changes apply on the next connect anyway.");
+            return;
+        }
+        // a cold resume without leaving vr mode: new device desc, swapchains and receiver.
+        StopRenderThread();
+        ReleaseStreamingResources();
+        AppResumed();
+        if (!Receiver || mClientState == cxrClientState_Exiting)
+        {
+            mControlChannel.Reply("error: reconnect failed.");
+            return;
+        }
+        StartRenderThread();
+        mControlChannel.Reply("ok: reconnecting to " + GOptions.mServerIP);
+        return;
+    }
+
+    // names are looked up first, so the sampler can be stopped before any of
+    // the options it reads are written.
+    struct Command
+    {
+        std::string tok, name, value;
+    };
+    std::vector<Command> commands;
+    std::string live, reconnect, failed;
+    bool applyLog = false, applySampler = false, applyClocks = false;
+    {
+        std::istringstream tokens(line);
+        std::string tok;
+        while (tokens >> tok)
+        {
+            Command command = { tok, (tok[0] == '-') ? tok.substr(1) : tok, "" };
+            std::transform(command.name.begin(), command.name.end(), command.name.begin(),
+                           [](unsigned char c){ return ::tolower(c); });
+            bool valueRequired = false;
+            if (!GOptions.FindOption(command.name, valueRequired))
+            {
+                failed += " " + tok + " (unknown)";
+                continue;
+            }
+            if (valueRequired && !(tokens >> command.value))
+            {
+                failed += " " + tok + " (no value)";
+                break;
+            }
+            const auto it = s_liveOptions.find(command.name);
+            applySampler |= (it != s_liveOptions.end() && it->second == LiveApply_Sampler);
+            commands.push_back(command);
+        }
+    }
+
+    // the sampler reads its rate and cpu once at start, so it restarts to pick them up.
+    const bool restartSampler = applySampler && !mWarmSuspended && mTrackingThreadRunning;
+    if (applySampler && !mWarmSuspended)
+        StopTrackingSampler();
+
+    applySampler = false;
+    {
+        // DoTracking reads these options and the filters under mTrackingMutex, from the
+        // sampler or, inline, from the server's callback thread, so write them under it too.
+        std::lock_guard<std::mutex> trackingLock(mTrackingMutex);
+        {
+            std::lock_guard<std::mutex> lock(GJniMutex);
+            for (const Command& command : commands)
+            {
+                if (GOptions.HandleOption(command.name, command.value) != ParseStatus_Success)
+                {
+                    failed += " " + command.tok + " (bad value)";
+                    continue;
+                }
+
+                const auto it = s_liveOptions.find(command.name);
+                const LiveApply apply = (it != s_liveOptions.end()) ? it->second : LiveApply_Reconnect;
+                (apply == LiveApply_Reconnect ? reconnect : live) += " " + command.tok;
+                applyLog |= (apply == LiveApply_Log);
+                applySampler |= (apply == LiveApply_Sampler);
+                applyClocks |= (apply == LiveApply_Clocks);
+            }
+        }
+
+        if (applySampler && !mWarmSuspended)
+        {
+            for (uint32_t handIndex = 0; handIndex < MAX_CONTROLLERS; handIndex++)
+                ResetInputState(handIndex);
+        }
+    }
+
+    if (applyLog)
+    {
+        ApplyLogLevelOptions();
+        ApplyLogFilterOptions();
+    }
+
+    if ((restartSampler || applySampler) && !mWarmSuspended && Receiver && mOvrSession != nullptr)
+        StartTrackingSampler();
+
+    if (applyClocks && mOvrSession != nullptr)
+        ConfigureClockLevels();
+
+    std::string reply = failed.empty() ? "ok:" : "error:" + failed + ";";
+    if (!live.empty())
+        reply += " live" + live + ";";
+    if (!reconnect.empty())
+        reply += " on reconnect" + reconnect + ";";
+    mControlChannel.Reply(reply);
+}
+
+
+//-----------------------------------------------------------------------------
+// The governor starts each vr session, or control channel change, at its
+// minimums and works up from there.
+//-----------------------------------------------------------------------------
+void CloudXRClientOVR::ConfigureClockLevels()
+{
+    int cpuLevel = CPU_LEVEL, gpuLevel = GPU_LEVEL;
+    if (GOptions.mClockGovernor)
+    {
+        mClockGovernor.Configure(GOptions.mCpuLevelMin, GOptions.mCpuLevelMax,
+                                 GOptions.mGpuLevelMin, GOptions.mGpuLevelMax);
+        cpuLevel = mClockGovernor.CpuLevel();
+        gpuLevel = mClockGovernor.GpuLevel();
+        mNextClockGovernorS = GetTimeInSeconds() + cxrClockGovernor::WindowS;
+    }
+    vrapi_SetClockLevels(mOvrSession, cpuLevel, gpuLevel);
+    CXR_LOGI("		vrapi_SetClockLevels( %d, %d )", cpuLevel, gpuLevel);
+}
 
 //-----------------------------------------------------------------------------
 //
@@ -1771,6 +3267,10 @@ void CloudXRClientOVR::AppPaused() {
 bool CloudXRClientOVR::EnterVRMode()
 {
     if (mOvrSession == NULL) {
+        // a warm resume keeps the session, anything else is a fresh startup.
+        if (!mWarmSuspended)
+            GStartup.Rearm();
+
         ovrModeParms parms = vrapi_DefaultModeParms(&mJavaCtx);
 
         // Note for future from ovr sdk: don't need to reset FS flag when using a View
@@ -1791,17 +3291,16 @@ bool CloudXRClientOVR::EnterVRMode()
             CXR_LOGE("EnterVrMode failed, assuming invalid ANativeWindow (%p)!", GetWindow());
             return false;
         }
+        GStartup.Mark(StartupTimeline::Phase_VrModeEntered);
 
         // Set performance parameters once we have entered VR mode and have a valid ovrMobile.
         if (mOvrSession != NULL) {
-            vrapi_SetClockLevels(mOvrSession, CPU_LEVEL, GPU_LEVEL);
-            CXR_LOGI("		vrapi_SetClockLevels( %d, %d )", CPU_LEVEL, GPU_LEVEL);
+            ConfigureClockLevels();
 
             vrapi_SetPerfThread(mOvrSession, VRAPI_PERF_THREAD_TYPE_MAIN, gettid());
             CXR_LOGI("		vrapi_SetPerfThread( MAIN, %d )", gettid());
 
-//            vrapi_SetPerfThread(mOvrSession, VRAPI_PERF_THREAD_TYPE_RENDERER, gettid());
-//            CXR_LOGI("		vrapi_SetPerfThread( RENDERER, %d )", gettid());
+            // RENDERER perf thread is registered by the render thread itself when it starts.
         }
     }
 
@@ -1829,17 +3328,31 @@ void CloudXRClientOVR::HandleVrModeChanges()
         {
             // then run app-layer resume code.
             AppResumed();
+            // swapchains are ready, rendering can start.
+            StartRenderThread();
         }
     }
     else
     {
         if (mIsPaused || mClientState == cxrClientState_Exiting)
         {
+            // decided before the threads stop, so the server's tracking polls
+            // get the held pose rather than reaching for a session going away.
+            if (mIsPaused && GOptions.mWarmSuspendS > 0 && Receiver &&
+                mClientState == cxrClientState_StreamingSessionInProgress)
+                mWarmSuspended = true;
+
+            // the sampler and render thread call into vrapi, so stop them before the session goes away.
+            StopTrackingSampler();
+            StopRenderThread();
+
             if (mOvrSession != NULL)
             {
                 CXR_LOGI("CALLING vrapi_LeaveVrMode()");
+                mHaptics.Stop();
                 vrapi_LeaveVrMode(mOvrSession);
                 mOvrSession = NULL;
+                mControllers.Clear();
             }
             // app-layer pause code
             AppPaused();
@@ -1853,10 +3366,14 @@ void CloudXRClientOVR::HandleVrModeChanges()
 oboe::DataCallbackResult CloudXRClientOVR::onAudioReady(oboe::AudioStream *oboeStream,
         void *audioData, int32_t numFrames)
 {
-    cxrAudioFrame recordedFrame{};
-    recordedFrame.streamBuffer = (int16_t*)audioData;
-    recordedFrame.streamSizeBytes = numFrames * CXR_AUDIO_CHANNEL_COUNT * CXR_AUDIO_SAMPLE_SIZE;
-    cxrSendAudio(Receiver, &recordedFrame);
+    if (oboeStream->getDirection() == oboe::Direction::Output)
+    {
+        mAudioPlayback.Read((int16_t*)audioData, numFrames);
+        return oboe::DataCallbackResult::Continue;
+    }
+
+    // just a copy, packetizing and sending happen on the capture thread.
+    mAudioCapture.Push((const int16_t*)audioData, numFrames, (int64_t)GetTimeInNS());
 
     return oboe::DataCallbackResult::Continue;
 }
@@ -1882,6 +3399,7 @@ void CloudXRClientOVR::HandleVrApiEvents()
                 break;
             case VRAPI_EVENT_VISIBILITY_GAINED:
                 CXR_LOGI("vrapi_PollEvent: Received VRAPI_EVENT_VISIBILITY_GAINED");
+                mControllers.Invalidate();
                 break;
             case VRAPI_EVENT_VISIBILITY_LOST:
                 CXR_LOGI("vrapi_PollEvent: Received VRAPI_EVENT_VISIBILITY_LOST");
@@ -1892,6 +3410,8 @@ void CloudXRClientOVR::HandleVrApiEvents()
                 // back to the application.
                 // TODO: to be implemented...
                 CXR_LOGI("vrapi_PollEvent: Received VRAPI_EVENT_FOCUS_GAINED");
+                // controllers may have slept or been swapped while the overlay had them.
+                mControllers.Invalidate();
                 break;
             case VRAPI_EVENT_FOCUS_LOST:
                 // FOCUS_LOST is sent when the application is no longer in the foreground and
@@ -1960,23 +3480,31 @@ Java_com_valiventures_cloudxr_ovr_MainActivity_nativeHandleLaunchOptions(JNIEnv*
     // For the moment, we prefer to set up logging as early as possible,
     // and it depends upon options having been parsed.
     // Set any logger options PRIOR to init call.
-    if (GOptions.mDebugFlags & cxrDebugFlags_LogQuiet) // quiet takes precedence
-        g_logFile.setLogLevel(cxrLL_Silence);
-    else if (GOptions.mDebugFlags & cxrDebugFlags_LogVerbose)
-        g_logFile.setLogLevel(cxrLL_Verbose);
-    else
-        g_logFile.setLogLevel(cxrLL_Debug); // otherwise defaults to Info.
-
-    g_logFile.setPrivacyEnabled((GOptions.mDebugFlags & cxrDebugFlags_LogPrivacyDisabled) ? 0 : 1);
+    ApplyLogLevelOptions();
     g_logFile.setMaxSizeKB(GOptions.mLogMaxSizeKB);
     g_logFile.setMaxAgeDays(GOptions.mLogMaxAgeDays);
+    g_logFile.setAsync(GOptions.mLogAsync);
 
     std::string filePrefix = "Oculus Sample";
     g_logFile.init(gClientHandle->GetOutputPath(), filePrefix);
 
-    // if running local latency test, clear server IP so we don't try to connect.
-    if (GOptions.mTestLatency && !GOptions.mServerIP.empty())
-        GOptions.mServerIP.clear();
+    // the macros reject by level and category before formatting from here on.
+    ApplyLogFilterOptions();
+    g_logFilter.deferred = GOptions.mLogDeferred && g_logFile.isAsyncRunning();
+    GStartup.Mark(StartupTimeline::Phase_OptionsParsed);
+
+    if (GOptions.mTestLatency)
+    {
+        // input and poses are timed from when they're sampled, so sample often.
+        if (GOptions.mTrackingRate <= 0 && !GOptions.mTrackingDisplayAligned)
+        {
+            GOptions.mTrackingRate = 1000.0f;
+            CXR_LOGI("Latency test: sampling tracking and input at %.0f hz.", GOptions.mTrackingRate);
+        }
+        // through a server, the frames also carry the client info a camera can read off the lens.
+        if (!GOptions.mServerIP.empty())
+            GOptions.mDebugFlags |= cxrDebugFlags_EmbedClientInfo;
+    }
 
     if (GOptions.mTestLatency)
         gClientHandle->SetDefaultBGColor(0xFF000000); // black for now.
@@ -2004,6 +3532,7 @@ Java_com_valiventures_cloudxr_ovr_MainActivity_nativeHandleLaunchOptions(JNIEnv*
 //-----------------------------------------------------------------------------
 void android_main(struct android_app* app)
 {
+    GStartup.Mark(StartupTimeline::Phase_NativeMain);
     cxrError status = cxrError_Success;
     GAndroidApp = app;
     CloudXRClientOVR cxrcOvr(app);
@@ -2029,6 +3558,7 @@ void android_main(struct android_app* app)
 
     CXR_LOGE("Exiting android_main, library is in limbo until process terminated.");
 
+    g_logFilter.deferred = false; // format inline again while the writer shuts down.
     g_logFile.destroy(); // just making it explicit.
 
     // TODO: after return, app_destroy doesn't terminate the process.  we need to unload and
@@ -26,6 +26,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 #include "VrApi.h"
 #include "VrApi_Helpers.h"
@@ -37,10 +40,30 @@
 
 #include "CloudXRClient.h"
 #include "EGLHelper.h"
+#include "SwapChainPool.h"
+#include "ControllerRegistry.h"
+#include "HapticScheduler.h"
+#include "AudioCapture.h"
+#include "FrameTiming.h"
+#include "LatencyTest.h"
+#include "StatsHud.h"
+#include "GpuTimer.h"
+#include "ControlChannel.h"
+#include "CloudXRMatrixHelpers.h"
+#include "CloudXRSeqLock.h"
+#include "CloudXRInputFilter.h"
+#include "CloudXRAudioJitterBuffer.h"
+#include "CloudXRStatsAggregator.h"
+#include "CloudXRQualityGovernor.h"
+#include "CloudXRClockGovernor.h"
+#include "CloudXRServerProbe.h"
+#include "CloudXRTrackingCapture.h"
 
 #include "oboe/Oboe.h"
 
 #define MAX_CONTROLLERS  2
+static_assert(MAX_CONTROLLERS == ControllerRegistry::MaxHands, "controller registry is indexed by hand");
+static_assert(1 + MAX_CONTROLLERS <= CXR_POSE_BATCH_MAX, "HMD and controllers convert in one pose batch");
 
 //-----------------------------------------------------------------------------
 //
@@ -49,10 +72,28 @@ class CloudXRClientOVR : public oboe::AudioStreamDataCallback
 {
     static constexpr uint32_t SwapChainLen = 3;
     static constexpr uint32_t NumEyes = 2;
+    enum AnalogAxis
+    {
+        AnalogAxis_IndexTrigger = 0,
+        AnalogAxis_GripTrigger,
+        AnalogAxis_JoystickX,
+        AnalogAxis_JoystickY,
+        AnalogAxisCount
+    };
     static constexpr float ClientPredictionOffset = 0.0;
     static constexpr float ServerPredictionOffset = 0.0;
+    static constexpr double MaxPredictionHorizon = 0.1; // seconds, beyond this prediction does more harm than good.
+    static constexpr double LatchSubmitMargin = 0.002; // seconds reserved for blit+submit after a latch.
+    static constexpr uint32_t FramesInFlight = 2; // GPU frames queued before we wait ahead of the latch.
     typedef std::unordered_map<GLuint, GLuint> FramebufferMap;
 
+    // what the tracking sampler thread publishes, everything a consumer needs from one poll.
+    typedef struct {
+        cxrVRTrackingState state;
+        ovrRigidBodyPosef headPose;
+        double sampleTimeS;
+    } TrackingSample;
+
     typedef enum {
         RenderState_Loading = 0,
         RenderState_Running = 1,
@@ -76,6 +117,7 @@ public:
 
     void SetPaused(bool p) { mIsPaused = p; }
     void RequestExit();
+    void WakeMainLoop();
 
     // have this a public status unless we decide to expose a getter method...
     static cxrClientCallbacks s_clientProxy;
@@ -83,6 +125,13 @@ public:
 private:
     void AppResumed();
     void AppPaused();
+    void ReleaseStreamingResources();
+    void UpdateWarmSuspend();
+    void UpdateServerSelection();
+    bool FailoverToNextServer();
+    void UpdateControlChannel();
+    void HandleControlCommand(const std::string& line);
+    void ConfigureClockLevels();
 
     bool EnterVRMode();
     void HandleVrModeChanges();
@@ -102,12 +151,21 @@ private:
     void UpdateClientState();
 
     void RecreateSwapchain(uint32_t width, uint32_t height, uint32_t eye);
+    void SetEyeSwapchain(uint32_t eye, const SwapChainPool::Entry& entry);
     bool SetupFramebuffer(GLuint colorTexture, uint32_t eye);
+    void ReleaseFramebuffers();
+    void ReleaseFrameFences();
+    float AddGpuTiming(const GpuTimer::Result& result);
+    void UpdateStatsHud(const FrameTimingRecord& timing);
 
     void DetectControllers();
     void ProcessControllers(float predictedTimeS);
+    void ResetInputState(uint32_t handIndex);
+    bool AddReceiverController(uint32_t handIndex);
 
-    cxrTrackedDevicePose ConvertPose(const ovrRigidBodyPosef& pose, float rotationX = 0);
+    // batch of up to CXR_POSE_BATCH_MAX, rotations[i] may be null.  only fills the kinematic fields.
+    void ConvertPoses(const ovrRigidBodyPosef* const inPoses[], const cxrQuaternion* const rotations[],
+                      cxrTrackedDevicePose* const outPoses[], uint32_t count);
     cxrDeviceDesc GetDeviceDesc(float fovX, float fovY);
 
     void SetHaptic(const cxrHapticFeedback& haptic);
@@ -116,19 +174,47 @@ private:
     void RenderLoadScreen();
     void RenderExitScreen();
     void Render();
+    uint32_t GetLatchBudgetMs();
+
+    void StartRenderThread();
+    void StopRenderThread();
+    void RenderThreadLoop();
 
     void DoTracking(double predictedTimeS);
+    void DoReplayTracking(double predictedTimeS);
+    void PollLatencyTestInput();
+    double GetPredictedTrackingTime();
+    ovrRigidBodyPosef GetLastHeadPose();
+    void PublishTrackingSample();
+    void UpdatePredictionLatency(double latchWaitS);
+    void UpdatePredictionError(const cxrMatrix34& renderedPose);
+
+    void StartTrackingSampler();
+    void StopTrackingSampler();
+    void TrackingSamplerLoop();
     cxrError QueryChaperone(cxrDeviceDesc* deviceDesc) const;
+    cxrError OpenAudioStreams(std::shared_ptr<oboe::AudioStream>& playback,
+                              std::shared_ptr<oboe::AudioStream>& recording);
+
+    void UpdateQualityGovernor();
+    void UpdateClockGovernor();
+    float GovernedDisplayRefresh() const;
 
     void FillBackground();
 
 protected:
-    CxrcRenderStates mRenderState = RenderState_Loading;
-    ovrInputStateTrackedRemote mLastInputState[MAX_CONTROLLERS] = {}; // cache prior state per controller.
+    std::atomic<CxrcRenderStates> mRenderState{RenderState_Loading};
+    ovrInputStateTrackedRemote mLastInputState[MAX_CONTROLLERS] = {}; // button/touch masks last sent per controller.
+    cxrAnalogInputFilter mAnalogFilters[MAX_CONTROLLERS][AnalogAxisCount]; // and analog values last sent.
+    ovrRigidBodyPosef mControllerRawPose[MAX_CONTROLLERS]; // this poll's controller tracking, before conversion.
+    bool mControllerPoseValid[MAX_CONTROLLERS] = {};
     struct android_app *mAndroidApp = NULL;
     ANativeWindow *mNativeWindow = NULL;
     ovrJava mJavaCtx;
-    EGLHelper mEglHelper;
+    EGLHelper mEglHelper; // main/lifecycle thread context, swapchains and receiver are created here.
+    EGLHelper mRenderEglHelper; // render thread context, same share group as above.
+    std::thread mRenderThread;
+    std::atomic<bool> mRenderThreadRunning{false};
     ovrMobile *mOvrSession = NULL; // pointer to oculus VrApi session object.
     uint64_t mFrameCounter = 0;
     uint32_t mControllersFound = 0;
@@ -136,12 +222,55 @@ protected:
     std::string mAppBasePath = "";
     std::string mAppOutputPath = "";
 
-    bool mRefreshChanged = false;
+    std::atomic<bool> mRefreshChanged{false};
     float_t mTargetDisplayRefresh = 0;
     const float_t cDefaultDisplayRefresh = 72.0f; // Can change this to hardcode alternate value...
 
-    double mNextDisplayTime = 0;
-    ovrRigidBodyPosef mLastHeadPose;
+    std::atomic<double> mNextDisplayTime{0};
+    std::atomic<double> mLastPoseSentS{0}; // when the newest tracking sample handed to the server was taken.
+    FrameTimingRecorder mFrameTimings; // render thread only.
+    // render thread only, both tied to its context.
+    GpuTimer mGpuTimer;
+    EGLHelper::Handle mFrameFences[FramesInFlight] = {};
+    // GPU blit time per frame, both eyes, over the stats interval.
+    float mGpuMsSum = 0;
+    float mGpuMsMax = 0;
+    uint32_t mGpuMsCount = 0;
+    float mGpuLastMs = -1.0f;
+    // -stats-hud, render thread only.  frame counts are since the last hud update.
+    StatsHud mStatsHud;
+    bool mStatsHudFailed = false;
+    uint32_t mHudFrames = 0;
+    uint32_t mHudRepeated = 0;
+    uint32_t mHudMissed = 0;
+    float mHudLatchMsSum = 0;
+    double mHudWindowStartS = 0;
+    ovrRigidBodyPosef mLastHeadPose; // DoTracking's, other threads read mTrackingSnapshot.
+
+    // dedicated tracking sampler, when enabled GetTrackingState just copies the latest snapshot.
+    // DoTracking runs under mTrackingMutex, so an inline poll from the server callback can't
+    // overlap the sampler across a live restart, and its result is published the same way.
+    std::thread mTrackingThread;
+    std::atomic<bool> mTrackingThreadRunning{false};
+    std::mutex mTrackingMutex;
+    cxrSeqLock<TrackingSample> mTrackingSnapshot;
+
+    // -tracking-record writes what DoTracking produces, -tracking-replay stands in for it.
+    cxrTrackingCapture mTrackingCapture;
+    cxrTrackingReplay mTrackingReplay;
+    std::vector<cxrControllerEvent> mReplayEvents; // scratch, tracking thread only.
+    bool mReplayFinished = false;
+    uint32_t mTrackingCaptures = 0; // numbers the files when a run connects more than once.
+
+    // -latency-test, fed from wherever tracking runs and read out on the render thread.
+    LatencyTest mLatencyTest;
+    double mLatencyNextLogS = 0;
+
+    // adaptive prediction: latency is measured on the render thread, consumed wherever tracking runs.
+    std::atomic<float> mPipelineLatency{0}; // seconds, round trip + client queue + latch wait.
+    std::atomic<float> mPredictionHorizon{0}; // seconds ahead of sample time we last predicted.
+    float mLatchWaitAvg = 0; // seconds, smoothed time spent blocked in cxrLatchFrame.
+    float mPredictionErrorDeg = 0; // smoothed angle between rendered pose and actual pose at display.
 
     volatile bool mIsPaused = true; // we start out in paused state
     bool mWasPaused = true; // so we can detect transitions.
@@ -151,28 +280,72 @@ protected:
     bool mHeadsetOnHead = true;
 
     cxrControllerHandle     m_newControllers[MAX_CONTROLLERS] = {};
-
-    GLuint Framebuffers[NumEyes];
+    ControllerRegistry      mControllers; // cached device caps and DeviceID per hand.
+    HapticScheduler         mHaptics;
+
+    // one FBO per eye per swapchain texture, owned by the render thread's context.
+    // per eye, as with an array swapchain both eyes attach different layers of the same texture.
+    FramebufferMap Framebuffers[NumEyes];
+    bool mFramebuffersStale = false; // set when pooled textures were destroyed or replaced.
+    // paused with the receiver, swapchains and device desc kept, see AppPaused.
+    std::atomic<bool> mWarmSuspended{false};
+    double mWarmSuspendStartS = 0;
+    // with several candidate servers: probed once at startup, then ranked best
+    // first.  mServerRank is the one in use, the rest are failover targets.
+    cxrServerProbe mServerProbe;
+    std::vector<std::string> mServerRanking;
+    uint32_t mServerRank = 0;
+    bool mServerSelected = false;
+    // option updates while running, see UpdateControlChannel.
+    ControlChannel mControlChannel;
+    bool mControlChannelTried = false;
 
     ovrMatrix4f TexCoordsFromTanAngles;
 
     ovrTextureSwapChain* SwapChains[VRAPI_FRAME_LAYER_EYE_MAX] = {};
+    SwapChainPool mSwapChainPools[VRAPI_FRAME_LAYER_EYE_MAX];
+    ovrMatrix4f EyeTexCoords[VRAPI_FRAME_LAYER_EYE_MAX]; // TexCoordsFromTanAngles scaled to the sub-rect in use.
+    ovrRectf EyeTextureRect[VRAPI_FRAME_LAYER_EYE_MAX];
 
-    uint32_t EyeWidth[VRAPI_FRAME_LAYER_EYE_MAX] = {};
+    int SwapChainIndex[VRAPI_FRAME_LAYER_EYE_MAX] = {}; // last image written per eye.
+
+    // last streamed frame, so we can resubmit it for reprojection when nothing new arrives.
+    bool mHaveLastFrame = false;
+    ovrRigidBodyPosef mLastFrameHeadPose = {};
+    uint32_t mRepeatedFrames = 0; // since last stats print.
+    double mLastStatsTime = 0;
+
+    uint32_t EyeWidth[VRAPI_FRAME_LAYER_EYE_MAX] = {}; // size of the frame, i.e. the sub-rect we render to.
     uint32_t EyeHeight[VRAPI_FRAME_LAYER_EYE_MAX] = {};
 
     std::shared_ptr<oboe::AudioStream> recordingStream{};
     std::shared_ptr<oboe::AudioStream> playbackStream{};
+    // set once the streams are opened and published, opening overlaps the connect.
+    std::atomic<bool> mAudioReady{false};
+    // RenderAudio fills it on the library's audio thread, the playback callback drains it.
+    cxrAudioJitterBuffer mAudioPlayback;
+    cxrAudioJitterBuffer::Stats mAudioStatsLast = {}; // as of the last stats print.
+    AudioCapture mAudioCapture; // fed by the recording callback, sends on its own thread.
 
     cxrVRTrackingState TrackingState = {};
     cxrReceiverHandle Receiver = nullptr;
-    cxrClientState mClientState = cxrClientState_ReadyToConnect;
+    std::atomic<cxrClientState> mClientState{cxrClientState_ReadyToConnect};
     cxrError mClientError = cxrError_Success;
     cxrDeviceDesc mDeviceDesc = {};
     cxrConnectionDesc mConnectionDesc = {};
     cxrConnectionStats mStats = {};
+    cxrStatsAggregator mStatsAggregator;
     int mFramesUntilStats = 60;
 
+    // levels survive reconnects, GetDeviceDesc applies the ones that can't change live.
+    cxrQualityGovernor mQualityGovernor;
+    double mNextGovernorS = 0;
+    std::vector<float> mGovernorRefreshRates; // display rates at or below the launch rate, fastest first.
+
+    // frames come in from the render thread, levels are judged and set on the main thread.
+    cxrClockGovernor mClockGovernor;
+    double mNextClockGovernorS = 0;
+
     uint32_t mDefaultBGColor = 0xFF000000; // black to start until we set around OnResume.
     uint32_t mBGColor = mDefaultBGColor;
 };